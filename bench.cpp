@@ -0,0 +1,316 @@
+/*
+ * version = d : 2.0
+ * file = s : "bench.cpp"
+ * project = s : "landb"
+ *
+ * (credits:
+ *          message = s : "Created by René Descartes Domingos Muala on 10/10/20."
+ *          Copyright = s : "© 2021 landia (René Muala). All rights reserved."
+ *          Contact = s : "renemuala@icloud.com"
+ * )
+ *
+ * usage = s : "landb_bench [max_bits] [shape ...]"
+ * shapes = a : [ s:"flat" s:"deep" s:"wide" s:"strings" s:"numeric" s:"people" ]
+ * output = s : "one CSV row per measurement: version,shape,bits,bytes,operation,variant,ops,seconds,ops_s,mb_s"
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include "landb.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/* Depth of the containers of the "deep" shape. */
+const size_t bench_depth = 8;
+
+/* Largest number of gets, sets and removes timed per measurement. */
+const size_t bench_ops = 1000000;
+
+/* Builds a landb-structure with about <bits> bits of a certain shape:
+ * flat (Key<i>=i), deep (containers nested bench_depth times), wide (one array), strings, numeric or people (mixed). */
+std::string make_shape(std::string const & shape, size_t bits){
+    std::string content;
+    if(shape == "flat"){
+        for(size_t i = 0 ; i < bits ; i++)
+            content += "Key" + std::to_string(i) + "=i:" + std::to_string(i) + " ";
+    } else if(shape == "deep"){
+        for(size_t i = 0 ; i < bits / (bench_depth + 1) ; i++){
+            content += "(Group" + std::to_string(i) + ": ";
+            for(size_t level = 1 ; level < bench_depth ; level++)
+                content += "(Level" + std::to_string(level) + ": ";
+            content += "Value=i:" + std::to_string(i) + " " + std::string(bench_depth, ')') + "\n";
+        }
+    } else if(shape == "wide"){
+        content += "Wide=a:[";
+        for(size_t i = 0 ; i < bits ; i++)
+            content += " i:" + std::to_string(i);
+        content += " ]\n";
+    } else if(shape == "strings"){
+        for(size_t i = 0 ; i < bits ; i++)
+            content += "Text" + std::to_string(i) + "=s:\"Landia \\\"database\\\" string number " + std::to_string(i) + " \\\\ end\"\n";
+    } else if(shape == "numeric"){
+        for(size_t i = 0 ; i < bits / 7 ; i++){
+            content += "(Sample" + std::to_string(i) + ": Id=x:" + std::to_string(i * 2654435761ull) + " Temperature=d:" + std::to_string(i / 7.0)
+            + " Ratio=f:" + std::to_string(1.0 / (i + 1)) + " Values=a:[ i:" + std::to_string(i) + " d:" + std::to_string(i * 0.001) + " l:-" + std::to_string(i) + " ] )\n";
+        }
+    } else if(shape == "people"){
+        for(size_t i = 0 ; i < bits / 10 ; i++){
+            content += "(Person" + std::to_string(i) + ": Name=s:\"Person \\\"" + std::to_string(i) + "\\\"\" Age=i:" + std::to_string(i % 90)
+            + " Average=d:" + std::to_string(i / 7.0) + " Grades=a:[ i:12 i:15 s:\"none\" (: Passed=b:1 ) ] )\n";
+        }
+    } return content;
+}
+
+/* Times a function, in seconds. */
+template<typename function>
+double seconds_of(function run){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Prints a measurement: <ops> operations (over <bytes> bytes, if any) in <seconds>. */
+void report(std::string const & shape, size_t bits, size_t bytes, std::string const & operation, std::string const & variant, size_t ops, double seconds){
+    std::cout << '"' << lan::db_version << "\"," << shape << "," << bits << "," << bytes << "," << operation << "," << variant << "," << ops << ","
+    << seconds << "," << ops / seconds << "," << ((bytes) ? (bytes / 1e6) / seconds : 0) << std::endl;
+}
+
+/* Writes <content> to a file. */
+void make_file(std::string const & name, std::string const & content){
+    lan::safe_file file;
+    file.open(name);
+    file.push(content);
+}
+
+/* Picks the i-th of <count> items in a scattered order. */
+size_t scatter(size_t i, size_t count){
+    return (i * 7919) % count;
+}
+
+/* Folds a value into a checksum, so that the timed gets aren't optimized away. */
+long long checksum(long long value){
+    return value;
+}
+
+long long checksum(std::string const & value){
+    return value.length();
+}
+
+/* Times pull and push, as text (one and every thread) and binary. */
+void bench_files(std::string const & shape, size_t bits, std::string const & content){
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    make_file("landb_bench.ldb", content);
+    for(size_t threads : {(size_t)1, cores}){
+        lan::db database;
+        std::string output;
+        lan::db_sink sink(output);
+        std::string variant = "text/threads=" + std::to_string(threads);
+        database.set_threads(threads);
+        database.connect("landb_bench.ldb");
+        report(shape, bits, content.length(), "pull", variant, 1, seconds_of([&](){ database.pull(); }));
+        report(shape, bits, content.length(), "push", variant, 1, seconds_of([&](){ database.push(sink); }));
+        if(threads == 1){
+            lan::safe_file file;
+            database.connect("landb_bench.ldbb");
+            double seconds = seconds_of([&](){ database.push(); });
+            file.open("landb_bench.ldbb");
+            report(shape, bits, file.length(), "push", "binary", 1, seconds);
+        } if(cores == 1) break;
+    } {
+        lan::safe_file file;
+        lan::db database;
+        file.open("landb_bench.ldbb");
+        database.connect("landb_bench.ldbb");
+        report(shape, bits, file.length(), "pull", "binary", 1, seconds_of([&](){ database.pull(); }));
+    } {
+        lan::db database;
+        report(shape, bits, content.length(), "parse", "cursor", 1, seconds_of([&](){ database.erase_bits(database.parse_all_bits(content)); }));
+        if(bits <= 10000)
+            report(shape, bits, content.length(), "parse", "legacy", 1, seconds_of([&](){ database.erase_bits(database.read_all_bits(content)); }));
+    } std::remove("landb_bench.ldb");
+    std::remove("landb_bench.ldbb");
+}
+
+/* Times gets, sets and removes by name of the top-level bits of a flat-like shape (<prefix><i>, of type <any>). */
+template<typename any>
+void bench_names(std::string const & shape, size_t bits, lan::db & database, std::string const & prefix){
+    size_t ops = std::min(bits, bench_ops);
+    std::vector<std::string> names;
+    std::vector<lan::handle> handles;
+    long long sum = 0;
+    for(size_t i = 0 ; i < bits ; i++){
+        names.push_back(prefix + std::to_string(i));
+        handles.emplace_back(names.back(), lan::db_bit_type_v<any>);
+    } report(shape, bits, 0, "get", "name", ops, seconds_of([&](){
+        for(size_t i = 0 ; i < ops ; i++)
+            sum += checksum(database.get<any>(names[scatter(i, bits)]));
+    })); report(shape, bits, 0, "get", "handle", ops, seconds_of([&](){
+        for(size_t i = 0 ; i < ops ; i++)
+            sum += checksum(database.get<any>(handles[scatter(i, bits)]));
+    })); report(shape, bits, 0, "set", "name", ops, seconds_of([&](){
+        for(size_t i = 0 ; i < ops ; i++){
+            size_t bit = scatter(i, bits);
+            database.assign<any>(names[bit], database.get<any>(names[bit]));
+        }
+    })); report(shape, bits, 0, "remove", "name", ops, seconds_of([&](){
+        for(size_t i = 0 ; i < ops ; i++)
+            database.remove(names[scatter(i, bits)], lan::db_bit_type_v<any>);
+    })); if(sum < 0) std::cout << sum;
+}
+
+/* Times the shape specific operations on a pulled database. */
+void bench_operations(std::string const & shape, size_t bits, std::string const & content){
+    lan::db database;
+    make_file("landb_bench.ldb", content);
+    database.connect("landb_bench.ldb");
+    database.pull();
+    std::remove("landb_bench.ldb");
+    if(shape == "flat") bench_names<int>(shape, bits, database, "Key");
+    else if(shape == "strings") bench_names<std::string>(shape, bits, database, "Text");
+    else if(shape == "wide"){
+        size_t ops = std::min(bits, bench_ops);
+        long long sum = 0;
+        report(shape, bits, 0, "get", "index", ops, seconds_of([&](){
+            for(size_t i = 0 ; i < ops ; i++)
+                sum += database.get<int>("Wide", scatter(i, bits));
+        })); report(shape, bits, 0, "items", "range", bits, seconds_of([&](){
+            for(int number : database.items<int>("Wide"))
+                sum += number;
+        })); report(shape, bits, 0, "size", "array", ops, seconds_of([&](){
+            for(size_t i = 0 ; i < ops ; i++)
+                sum += database.size("Wide");
+        })); report(shape, bits, 0, "remove", "index", std::min(ops, (size_t)10000), seconds_of([&](){
+            // removing an item is linear on the size of the array (see db::erase_bit), the count is kept small.
+            for(size_t i = 0 ; i < std::min(ops, (size_t)10000) ; i++)
+                database.remove("Wide", 0);
+        })); if(sum < 0) std::cout << sum;
+        lan::db built;
+        built.declare("Wide", lan::Array);
+        report(shape, bits, 0, "iterate", "array", bits, seconds_of([&](){
+            for(size_t i = 0 ; i < bits ; i++)
+                built.iterate<int>("Wide", (int)i, lan::Int);
+        }));
+    } else if(shape == "deep"){
+        size_t groups = bits / (bench_depth + 1), ops = std::min(groups, bench_ops);
+        std::vector<std::string> contexts;
+        std::vector<lan::path> paths;
+        long long sum = 0;
+        for(size_t i = 0 ; i < groups ; i++){
+            std::string context = "Group" + std::to_string(i);
+            for(size_t level = 1 ; level < bench_depth ; level++)
+                context += ".Level" + std::to_string(level);
+            contexts.push_back(context);
+            paths.emplace_back(context + ".Value");
+        } report(shape, bits, 0, "get", "dotted", ops, seconds_of([&](){
+            for(size_t i = 0 ; i < ops ; i++)
+                sum += database.get<int>(contexts[scatter(i, groups)], "Value");
+        })); report(shape, bits, 0, "get", "path", ops, seconds_of([&](){
+            for(size_t i = 0 ; i < ops ; i++)
+                sum += database.get<int>(paths[scatter(i, groups)]);
+        })); report(shape, bits, 0, "set", "path", ops, seconds_of([&](){
+            for(size_t i = 0 ; i < ops ; i++)
+                database.assign<int>(paths[scatter(i, groups)], (int)i);
+        })); if(sum < 0) std::cout << sum;
+    } else if(shape == "numeric"){
+        size_t samples = bits / 7, ops = std::min(samples, bench_ops);
+        double sum = 0;
+        report(shape, bits, 0, "get", "context", ops, seconds_of([&](){
+            for(size_t i = 0 ; i < ops ; i++)
+                sum += database.get<double>("Sample" + std::to_string(scatter(i, samples)), "Temperature");
+        })); if(sum < 0) std::cout << sum;
+    } else if(shape == "people"){
+        size_t people = bits / 10, ops = std::min(people, bench_ops);
+        size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::string> names;
+        double sum = 0;
+        for(size_t i = 0 ; i < people ; i++)
+            names.push_back("Person" + std::to_string(i));
+        report(shape, bits, 0, "get", "context", ops * 3, seconds_of([&](){
+            for(size_t i = 0 ; i < ops ; i++){
+                std::string const & person = names[scatter(i, people)];
+                sum += database.get<int>(person, "Age") + database.get<double>(person, "Average") + database.get<std::string>(person, "Name").length();
+            }
+        })); report(shape, bits, 0, "get", "batch", ops * 3, seconds_of([&](){
+            for(size_t i = 0 ; i < ops ; i++){
+                database.batch(names[scatter(i, people)], [&](lan::db::fields const & fields){
+                    sum += fields.get<int>("Age") + fields.get<double>("Average") + fields.get<std::string>("Name").length();
+                });
+            }
+        })); database.set_concurrent(true);
+        for(size_t threads = 1 ; threads <= cores ; threads *= 2){
+            std::vector<std::thread> readers;
+            report(shape, bits, 0, "get", "concurrent/threads=" + std::to_string(threads), ops * threads, seconds_of([&](){
+                for(size_t t = 0 ; t < threads ; t++){
+                    readers.emplace_back([&, t](){
+                        long long ages = 0;
+                        for(size_t i = 0 ; i < ops ; i++)
+                            ages += database.get<int>(names[scatter(i + t, people)], "Age");
+                        if(ages < 0) std::cout << ages;
+                    });
+                } for(std::thread & reader : readers)
+                    reader.join();
+            }));
+        } if(sum < 0) std::cout << sum;
+    }
+}
+
+/* Times the structural char scan of each supported instruction set. */
+void bench_scan(std::string const & shape, size_t bits, std::string const & content){
+    for(lan::db_scan_level level : {lan::scan_scalar, lan::scan_sse2, lan::scan_avx2}){
+        size_t found = 0;
+        lan::db_scanner::set_level(level);
+        if(lan::db_scanner::level() != level) continue;
+        report(shape, bits, content.length(), "scan", "level=" + std::to_string(level), 1, seconds_of([&](){
+            for(size_t offset = 0 ; (offset = lan::db_scanner::quote(content, offset)) < content.length() ; offset++)
+                found++;
+        })); if(found == 0) std::cout << "";
+    } lan::db_scanner::set_level(lan::scan_avx2);
+}
+
+/* Times setting string bits by copy, by move and in place. */
+void bench_strings(std::string const & shape, size_t bits){
+    std::vector<std::string> keys;
+    for(size_t i = 0 ; i < bits ; i++)
+        keys.push_back("Text" + std::to_string(i));
+    for(std::string variant : {"copy", "move", "emplace"}){
+        lan::db database;
+        std::vector<std::string> values;
+        for(size_t i = 0 ; i < bits ; i++)
+            values.emplace_back(64, 'a' + i % 26);
+        report(shape, bits, 0, "set", variant, bits, seconds_of([&](){
+            for(size_t i = 0 ; i < bits ; i++){
+                if(variant == "copy") database.set<std::string>(keys[i], values[i]);
+                else if(variant == "move") database.set<std::string>(keys[i], std::move(values[i]));
+                else database.emplace<std::string>(keys[i], 64, 'a' + i % 26);
+            }
+        }));
+    }
+}
+
+int main (int argc, const char * argv []) {
+
+    size_t max_bits = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    std::vector<std::string> shapes;
+
+    for(int i = 2 ; i < argc ; i++)
+        shapes.push_back(argv[i]);
+    if(shapes.empty())
+        shapes = {"flat", "deep", "wide", "strings", "numeric", "people"};
+
+    std::cout << "version,shape,bits,bytes,operation,variant,ops,seconds,ops_s,mb_s\n";
+
+    for(std::string const & shape : shapes){
+        for(size_t bits = 1000 ; bits <= max_bits and bits <= 10000000 ; bits *= 10){
+            std::string content = make_shape(shape, bits);
+            bench_files(shape, bits, content);
+            bench_operations(shape, bits, content);
+            if(shape == "people") bench_scan(shape, bits, content);
+            if(shape == "strings") bench_strings(shape, bits);
+        }
+    }
+
+}
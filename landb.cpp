@@ -10,15 +10,93 @@
  */
 
 #include "landb.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LANDB_X86 1
+#include <immintrin.h>
+#endif
+
+#ifdef LANDB_STATS
+#define LANDB_COUNT(counter, amount) (counters.counter += (amount))
+#define LANDB_TIME(counter) lan::db_timer counter##_timer (counters.counter)
+#else
+#define LANDB_COUNT(counter, amount) ((void)0)
+#define LANDB_TIME(counter) ((void)0)
+#endif
 
 namespace lan 
 {
     
+#ifdef LANDB_STATS
+    /* Adds the time it lives to a counter, in nanoseconds. */
+    struct db_timer {
+        std::atomic<uint64_t> & counter;
+        std::chrono::steady_clock::time_point start;
+        
+        db_timer(std::atomic<uint64_t> & counter) : counter(counter), start(std::chrono::steady_clock::now()){}
+        
+        ~db_timer(){
+            counter.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+        }
+    };
+#endif
+    
+    /* lan::db_sink */
+    
+    db_sink::db_sink(int fd){
+        this->fd = fd;
+        target = nullptr;
+        failed = (fd < 0);
+        buffer.reserve(db_sink_size);
+    }
+    
+    db_sink::db_sink(std::string & target){
+        fd = -1;
+        this->target = &target;
+        failed = false;
+    }
+    
+    bool db_sink::flush(){
+        bool done = write_fd(buffer);
+        buffer.clear();
+        return done;
+    }
+    
+    bool db_sink::write_fd(std::string_view data){
+        ssize_t length;
+        while(not failed and data.length()){
+            if((length = ::write(fd, data.data(), data.length())) < 0){
+                if(errno != EINTR) failed = true;
+            } else data.remove_prefix(length);
+        } return not failed;
+    }
+    
+    bool db_sink::good() const {
+        return not failed;
+    }
+    
+    db_sink::~db_sink(){
+        if(not target) flush();
+    }
+    
     /* lan::safe_file */
     
     safe_file::safe_file(){
         file = nullptr;
         filename = "";
+        map = nullptr;
+        map_length = 0;
     }
     
     bool safe_file::open(std::string filename){
@@ -26,6 +104,11 @@ namespace lan
         return (this->filename = filename).length() and check();
     }
     
+    bool safe_file::assign(std::string filename){
+        close();
+        return (this->filename = filename).length();
+    }
+    
     bool safe_file::check(){
         close_fd();
         file = fopen(filename.data(), "r+");
@@ -34,36 +117,92 @@ namespace lan
     }
     
     bool safe_file::push(std::string data){
+        return push([&](lan::db_sink & sink){ sink.write(data); });
+    }
+    
+    bool safe_file::push(std::function<void(lan::db_sink &)> writer){
+        int fd;
+        bool done;
+        struct stat original;
+        std::string temporary = filename + ".tmp";
         close_fd();
-        if((file = fopen(filename.data(), "w"))){
-            return fwrite(data.data(), sizeof(char), data.length(), file);
-        } return false;
+        if(filename.empty() or (fd = ::open(temporary.data(), O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
+            return false;
+        if(stat(filename.data(), &original) == 0){
+            fchmod(fd, original.st_mode & 07777);
+            if(fchown(fd, original.st_uid, original.st_gid) != 0) {}  // keeps the owner when allowed to
+        } try {
+            db_sink sink(fd);
+            writer(sink);
+            done = sink.flush();
+        } catch (...) {
+            ::close(fd);
+            ::unlink(temporary.data());
+            throw;
+        } done = (::close(fd) == 0) and done and ::rename(temporary.data(), filename.data()) == 0;
+        if(not done) ::unlink(temporary.data());
+        return done;
+    }
+    
+    bool safe_file::append(std::string_view data){
+        int fd;
+        bool done;
+        close_fd();
+        if(filename.empty() or (fd = ::open(filename.data(), O_WRONLY | O_CREAT | O_APPEND, 0666)) < 0)
+            return false;
+        {
+            db_sink sink(fd);
+            done = sink.write(data).flush();
+        } return (::close(fd) == 0) and done;
+    }
+    
+    std::string safe_file::name() const {
+        return filename;
     }
     
     std::string safe_file::pull(){
         close_fd();
         std::string data = ("");
-        if((file = fopen(filename.data(), "r"))){
-            char data_c = 0;
-            while(!feof(file)){
-                if(data_c != 0) data+=data_c; fread(&data_c, sizeof(char), 1, file); 
-            }
+        struct stat info;
+        if((file = fopen(filename.data(), "r")) and fstat(fileno(file), &info) == 0){
+            data.resize(info.st_size);
+            data.resize(fread(data.data(), sizeof(char), data.length(), file));
         } return data;
     }
     
-    size_t safe_file::length(){
-        close_fd();
-        size_t length = 0;
-        if((file = fopen(filename.data(), "r"))){
-            char data_c = 0;
-            while(!feof(file)){
-                fread(&data_c, sizeof(char), 1, file); length++;
+    std::string_view safe_file::view(){
+        int fd;
+        struct stat info;
+        unmap();
+        if((fd = ::open(filename.data(), O_RDONLY)) < 0)
+            return std::string_view();
+        if(fstat(fd, &info) == 0 and info.st_size > 0){
+            map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(map == MAP_FAILED) map = nullptr;
+            else {
+                map_length = info.st_size;
+                madvise(map, map_length, MADV_SEQUENTIAL);
             }
-        } return length;
+        } ::close(fd);
+        return (map) ? std::string_view((const char *)map, map_length) : std::string_view();
+    }
+    
+    bool safe_file::unmap(){
+        if(map) munmap(map, map_length);
+        map = nullptr;
+        map_length = 0;
+        return true;
+    }
+    
+    size_t safe_file::length(){
+        struct stat info;
+        if(file) fflush(file);
+        return (stat(filename.data(), &info) == 0) ? info.st_size : 0;
     }
     
     bool safe_file::close(){
         filename = "";
+        unmap();
         close_fd();
         return !(filename).length();
     }
@@ -75,9 +214,390 @@ namespace lan
     }
     
     safe_file::~safe_file(){
+        unmap();
         close_fd();
     }
     
+    /* lan::db_arena */
+    
+    db_arena::db_arena(){
+        slabs = nullptr;
+        larges = nullptr;
+        free_bits = nullptr;
+        for(size_t i = 0 ; i < db_arena_classes ; i++)
+            free_payloads[i] = nullptr;
+        counters = {0, 0, 0, 0, 0, 0, 0};
+    }
+    
+    void * db_arena::allocate(size_t size){
+        slab * target = slabs;
+        size = (size + 15) & ~(size_t)15;
+        if(not target or target->used + size > target->size){
+            size_t length = (size > db_arena_slab_size / 4) ? size : db_arena_slab_size;
+            target = (slab*)::operator new(sizeof(slab) + 16 + length);
+            target->size = length;
+            target->used = 0;
+            if(slabs and length != db_arena_slab_size){
+                target->nex = slabs->nex; slabs->nex = target;
+            } else {
+                target->nex = slabs; slabs = target;
+            }
+            counters.slabs++;
+            counters.reserved += length;
+        }
+        void * memory = ((char*)target) + ((sizeof(slab) + 15) & ~(size_t)15) + target->used;
+        target->used += size;
+        counters.used += size;
+        return memory;
+    }
+    
+    lan::db_bit * db_arena::make_bit(){
+        void * memory = free_bits;
+        if(memory) {
+            free_bits = free_bits->nex;
+            counters.recycled -= sizeof(db_bit);
+        } else memory = allocate(sizeof(db_bit));
+        LANDB_COUNT(allocations, 1);
+        counters.bits++;
+        return new (memory) db_bit;
+    }
+    
+    void db_arena::release_bit(lan::db_bit * bit){
+        if(bit->data and not bit->inlined()) drop(bit->data);
+        bit->~db_bit();
+        free_node * node = (free_node*)bit;
+        node->nex = free_bits;
+        free_bits = node;
+        counters.bits--;
+        counters.recycled += sizeof(db_bit);
+    }
+    
+    void * db_arena::make_payload(size_t size, void (* destroy)(void *), bool apart){
+        size_t length = sizeof(payload_header) + ((size + 15) & ~(size_t)15), type;
+        if(apart) length = std::max(length, (db_arena_classes + 2) * 16);
+        type = length / 16 - 2;
+        payload_header * header;
+        if(type < db_arena_classes and free_payloads[type]){
+            header = (payload_header*)free_payloads[type];
+            free_payloads[type] = free_payloads[type]->nex;
+            counters.recycled -= length;
+        } else if(type < db_arena_classes){
+            header = (payload_header*)allocate(length);
+        } else {
+            large_node * node = (large_node*)::operator new(sizeof(large_node) + length);
+            node->pre = nullptr;
+            if((node->nex = larges)) larges->pre = node;
+            larges = node;
+            header = (payload_header*)(node + 1);
+            counters.reserved += length;
+        }
+        header->destroy = destroy;
+        header->size = length;
+        LANDB_COUNT(allocations, 1);
+        counters.payloads++;
+        return header + 1;
+    }
+    
+    void db_arena::drop(void * payload){
+        payload_header * header = ((payload_header*)payload) - 1;
+        size_t length = header->size, type = length / 16 - 2;
+        if(header->destroy) header->destroy(payload);
+        if(type < db_arena_classes){
+            free_node * node = (free_node*)header;
+            node->nex = free_payloads[type];
+            free_payloads[type] = node;
+            counters.recycled += length;
+        } else {
+            large_node * node = ((large_node*)header) - 1;
+            if(node->pre) node->pre->nex = node->nex;
+            else larges = node->nex;
+            if(node->nex) node->nex->pre = node->pre;
+            ::operator delete(node);
+            counters.reserved -= length;
+        } counters.payloads--;
+    }
+    
+    void * db_arena::adopt(db_arena & owner, void * payload){
+        large_node * node = ((large_node*)(((payload_header*)payload) - 1)) - 1;
+        size_t length = size_of(payload);
+        if(node->pre) node->pre->nex = node->nex;
+        else owner.larges = node->nex;
+        if(node->nex) node->nex->pre = node->pre;
+        node->pre = nullptr;
+        if((node->nex = larges)) larges->pre = node;
+        larges = node;
+        owner.counters.reserved -= length;
+        owner.counters.payloads--;
+        counters.reserved += length;
+        counters.payloads++;
+        return payload;
+    }
+    
+    void db_arena::discard_bit(lan::db_bit * bit){
+        if(bit->data and not bit->inlined()){
+            payload_header * header = ((payload_header*)bit->data) - 1;
+            if(header->destroy) header->destroy(bit->data);
+        } bit->~db_bit();
+    }
+    
+    void db_arena::release(){
+        while(slabs){
+            slab * buffer = slabs;
+            slabs = slabs->nex;
+            ::operator delete(buffer);
+        } while(larges){
+            large_node * buffer = larges;
+            larges = larges->nex;
+            ::operator delete(buffer);
+        } free_bits = nullptr;
+        for(size_t i = 0 ; i < db_arena_classes ; i++)
+            free_payloads[i] = nullptr;
+        counters = {0, 0, 0, 0, 0, 0, counters.allocations};
+    }
+    
+    void db_arena::merge(db_arena & other){
+        slab * tail = other.slabs;
+        free_node * node;
+        if(tail){
+            while(tail->nex) tail = tail->nex;
+            if(slabs) {tail->nex = slabs->nex; slabs->nex = other.slabs;}
+            else slabs = other.slabs;
+        } if(other.larges){
+            large_node * last = other.larges;
+            while(last->nex) last = last->nex;
+            if((last->nex = larges)) larges->pre = last;
+            larges = other.larges;
+        } if((node = other.free_bits)){
+            while(node->nex) node = node->nex;
+            node->nex = free_bits; free_bits = other.free_bits;
+        } for(size_t i = 0 ; i < db_arena_classes ; i++){
+            if((node = other.free_payloads[i])){
+                while(node->nex) node = node->nex;
+                node->nex = free_payloads[i]; free_payloads[i] = other.free_payloads[i];
+            } other.free_payloads[i] = nullptr;
+        }
+        counters.slabs += other.counters.slabs;
+        counters.reserved += other.counters.reserved;
+        counters.used += other.counters.used;
+        counters.recycled += other.counters.recycled;
+        counters.bits += other.counters.bits;
+        counters.payloads += other.counters.payloads;
+        counters.allocations += other.counters.allocations;
+        other.slabs = nullptr;
+        other.larges = nullptr;
+        other.free_bits = nullptr;
+        other.counters = {0, 0, 0, 0, 0, 0, 0};
+    }
+    
+    lan::db_arena_stats db_arena::stats() const {
+        return counters;
+    }
+    
+    size_t db_arena::size_of(void * payload){
+        return (((payload_header*)payload) - 1)->size;
+    }
+    
+    db_arena::~db_arena(){
+        release();
+    }
+    
+    /* lan::db_scanner */
+    
+    /* Membership table of a set of chars. */
+    template<char... set>
+    struct db_scan_table {
+        bool table [256] = {};
+        constexpr db_scan_table(){
+            ((table[(unsigned char)set] = true), ...);
+        }
+    };
+    
+    template<char... set>
+    static constexpr db_scan_table<set...> db_scan_chars {};
+    
+    /* Finds the first char of a set (or out of it) one char at a time, up to an end. */
+    template<char... set>
+    static size_t find_scalar(std::string_view content, size_t offset, size_t end, bool inside){
+        for( ; offset < end ; offset++)
+            if(db_scan_chars<set...>.table[(unsigned char)content[offset]] == inside) return offset;
+        return end;
+    }
+    
+#ifdef LANDB_X86
+    /* Finds the first char of a set (or out of it) 16 bytes at a time. */
+    template<char... set>
+    __attribute__((target("sse2")))
+    static size_t find_sse2(std::string_view content, size_t offset, bool inside){
+        const char * data = content.data();
+        unsigned mask;
+        for( ; offset + 16 <= content.length() ; offset += 16){
+            __m128i block = _mm_loadu_si128((const __m128i *)(data + offset)), hits = _mm_setzero_si128();
+            ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(set)))), ...);
+            mask = (unsigned)_mm_movemask_epi8(hits);
+            if((mask = (inside) ? mask : ~mask & 0xffff)) return offset + __builtin_ctz(mask);
+        } return find_scalar<set...>(content, offset, content.length(), inside);
+    }
+    
+    /* Finds the first char of a set (or out of it) 32 bytes at a time. */
+    template<char... set>
+    __attribute__((target("avx2")))
+    static size_t find_avx2(std::string_view content, size_t offset, bool inside){
+        const char * data = content.data();
+        unsigned mask;
+        for( ; offset + 32 <= content.length() ; offset += 32){
+            __m256i block = _mm256_loadu_si256((const __m256i *)(data + offset)), hits = _mm256_setzero_si256();
+            ((hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(set)))), ...);
+            mask = (unsigned)_mm256_movemask_epi8(hits);
+            if((mask = (inside) ? mask : ~mask)) return offset + __builtin_ctz(mask);
+        } return find_sse2<set...>(content, offset, inside);
+    }
+    
+    static db_scan_level scan_supported(){
+        __builtin_cpu_init();
+        return (__builtin_cpu_supports("avx2")) ? scan_avx2 : (__builtin_cpu_supports("sse2")) ? scan_sse2 : scan_scalar;
+    }
+#else
+    static db_scan_level scan_supported(){
+        return scan_scalar;
+    }
+#endif
+    
+    static const db_scan_level scan_best = scan_supported();
+    static std::atomic<db_scan_level> scan_current (scan_best);  // set_level may race with parsing threads
+    
+    //! @brief bytes checked one at a time before a scan switches to vectors (most tokens are shorter).
+    static const size_t db_scan_prefix = 16;
+    
+    /* Finds the first char of a set (or out of it) with the current instruction set. */
+    template<char... set>
+    static size_t find_set(std::string_view content, size_t offset, bool inside){
+        size_t end = std::min(content.length(), offset + db_scan_prefix);
+        if((offset = find_scalar<set...>(content, offset, end, inside)) < content.length() and offset < end) return offset;
+#ifdef LANDB_X86
+        db_scan_level level = scan_current.load(std::memory_order_relaxed);
+        if(level == scan_avx2 and offset < content.length()) return find_avx2<set...>(content, offset, inside);
+        if(level == scan_sse2 and offset < content.length()) return find_sse2<set...>(content, offset, inside);
+#endif
+        return find_scalar<set...>(content, offset, content.length(), inside);
+    }
+    
+    size_t db_scanner::structural(std::string_view content, size_t offset){
+        return find_set<' ', '\n', '\t', '\r', '=', ':', ';', '(', ')', '[', ']', '"'>(content, offset, true);
+    }
+    
+    size_t db_scanner::non_blank(std::string_view content, size_t offset){
+        return find_set<' ', '\n', '\t', '\r'>(content, offset, false);
+    }
+    
+    size_t db_scanner::quote(std::string_view content, size_t offset){
+        return find_set<'"', '\\'>(content, offset, true);
+    }
+    
+    size_t db_scanner::bracket(std::string_view content, size_t offset){
+        return find_set<'"', '(', ')', '[', ']'>(content, offset, true);
+    }
+    
+    db_scan_level db_scanner::level(){
+        return scan_current.load(std::memory_order_relaxed);
+    }
+    
+    void db_scanner::set_level(db_scan_level level){
+        scan_current.store(std::min(level, scan_best), std::memory_order_relaxed);
+    }
+    
+    /* lan::path */
+    
+    path::path(std::string_view address) : address(address){
+        size_t start = 0, end;
+        do {
+            end = std::min(this->address.find('.', start), this->address.length());
+            steps.push_back({start, end - start});
+            start = end + 1;
+        } while(end < this->address.length());
+    }
+    
+    size_t path::size() const {
+        return steps.size();
+    }
+    
+    std::string_view path::operator [](size_t step) const {
+        return std::string_view(address).substr(steps[step].first, steps[step].second);
+    }
+    
+    std::string_view path::back() const {
+        return (steps.size()) ? (*this)[steps.size() - 1] : std::string_view();
+    }
+    
+    std::string const & path::str() const {
+        return address;
+    }
+    
+    /* lan::db_cursor */
+    
+    enum db_char_class {_other, _blank, _delimiter, _single};
+    
+    static struct db_char_table {
+        unsigned char table [256];
+        db_char_table(){
+            for(size_t i = 0 ; i < 256 ; i++) table[i] = _other;
+            for(char ch : std::string_view(" \n\t\r")) table[(unsigned char)ch] = _blank;
+            for(char ch : std::string_view("=:;()[]")) table[(unsigned char)ch] = _single;
+            table[(unsigned char)','] = _delimiter;
+        }
+    } db_chars;
+    
+    db_cursor::db_cursor(std::string_view content){
+        this->content = content;
+        offset = 0;
+        peeked = false;
+    }
+    
+    size_t db_cursor::string_end(std::string_view content, size_t offset){
+        while((offset = db_scanner::quote(content, offset)) < content.length()){
+            if(content[offset] == '"') return offset;
+            offset += 2;
+        } return content.length();
+    }
+    
+    std::string_view db_cursor::scan(){
+        size_t start;
+        unsigned char type;
+        if((start = offset = db_scanner::non_blank(content, offset)) >= content.length()) return std::string_view();
+        if((type = db_chars.table[(unsigned char)content[offset]]) == _single or type == _delimiter)
+            return content.substr(offset++, 1);
+        while((offset = db_scanner::structural(content, offset)) < content.length() and content[offset] == '"')
+            offset = string_end(content, offset+1) + 1;
+        return content.substr(start, std::min(offset, content.length()) - start);
+    }
+    
+    std::string_view db_cursor::next(){
+        if(peeked) {peeked = false; return lookahead;}
+        return scan();
+    }
+    
+    std::string_view db_cursor::peek(){
+        if(not peeked) {lookahead = scan(); peeked = true;}
+        return lookahead;
+    }
+    
+    std::string_view db_cursor::skip_block(){
+        size_t start = offset = position(), depth = 1;
+        peeked = false;
+        while(depth and (offset = db_scanner::bracket(content, offset)) < content.length()){
+            switch(content[offset]){
+                case '"': offset = string_end(content, offset+1); break;
+                case '(': case '[': depth++; break;
+                case ')': case ']': depth--; break;
+                default: break;
+            } offset++;
+        } offset = std::min(offset, content.length());
+        return content.substr(start, offset - start);
+    }
+    
+    size_t db_cursor::position() const {
+        return (peeked) ? offset - lookahead.length() : offset;
+    }
+    
     /* lan::db */
     
     char db_bit_table [11] = {  'b' ,   'i' ,
@@ -88,78 +608,369 @@ namespace lan
         '#' };
         
         db::db(){
+            format = Text;
+            lazy = false;
+            threads = 1;
+            journaling = false;
+            journal_element = nullptr;
+            journal_index = journal_structure = 0;
+            concurrent = false;
+            frozen = false;
+            shared = false;
+            generation = 0;
+            restructure();
+            pushes = std::make_shared<db_push_state>();
+            index = nullptr;
+            indexing = true;
             reset_data();
+            reset_stats();
+        }
+        
+        //! @brief source of db::structure, shared by every database so a handle can't match a database that didn't resolve it.
+        static std::atomic<size_t> db_structures (1);
+        
+        void db::restructure(){
+            structure = db_structures++;
         }
         
         /* -- */
         
         void db::erase_bits(db_bits * bits){
+            lan::db_bit * buffer;
+            restructure();
             while (bits) {
-                data = bits;
+                buffer = bits;
                 bits  = bits->nex;
-                if(data->lin)
-                    erase_bits(data->lin);
-                delete data;
-                data = nullptr;
-            }
+                if(buffer->pending)
+                    drop_pending(buffer);
+                if(buffer->lin)
+                    erase_bits(buffer->lin);
+                arena.release_bit(buffer);
+            } data = nullptr;
         }
         
         void db::erase_bit(db_bit * bit){
             if(bit){
+                restructure();
+                unindex_bit(bit);
                 if(bit->pre)
                     bit->pre->nex = bit->nex;
                 else if(bit->con)
                     bit->con->lin = bit->nex;
-                first = (bit == first) ? first->nex : first ;
-                last = (bit == last) ? last->pre : last;
+                if(bit->nex)
+                    bit->nex->pre = bit->pre;
+                if(bit->con and bit->con->items){
+                    lan::db_array::iterator item = std::find(bit->con->items->begin(), bit->con->items->end(), bit);
+                    if(item != bit->con->items->end()) bit->con->items->erase(item);
+                }
+                if(bit->con and bit->con->tail){
+                    bit->con->count--;
+                    if(bit->con->tail == bit) bit->con->tail = bit->pre;
+                } else if(not bit->con and last){
+                    length--;
+                    if(bit == last) last = bit->pre;
+                } first = (bit == first) ? first->nex : first ;
+                if(bit->pending)
+                    drop_pending(bit);
                 if(bit->lin)
                     erase_bits(bit->lin);
-                delete bit;
+                arena.release_bit(bit);
                 bit = nullptr;
             }
         }
         
+        void db::discard_bits(db_bits * bits){
+            lan::db_bit * buffer;
+            while (bits) {
+                buffer = bits;
+                bits = bits->nex;
+                if(buffer->lin)
+                    discard_bits(buffer->lin);
+                if(frozen and buffer->type == Unsafe)  // the payloads of a snapshot belong to the database it was taken from
+                    buffer->data = nullptr;
+                arena.discard_bit(buffer);
+            }
+        }
+        
+        void db::release_bits(){
+            restructure();
+            discard_bits(first);
+            pending.clear();
+            std::string().swap(source);
+            if(index) {delete index; index = nullptr;}
+            arena.release();
+            data = first = last = anchor = nullptr;
+            length = 0;
+        }
+        
+        void db::clear_bit(db_bit * bit){
+            drop_data(bit);
+            if(bit->pending) drop_pending(bit);
+            if(bit->lin) {erase_bits(bit->lin); bit->lin = nullptr;}
+            bit->tail = nullptr;
+            bit->count = 0;
+            if(bit->index) {delete bit->index; bit->index = nullptr;}
+            if(bit->items) {delete bit->items; bit->items = nullptr;}
+        }
+        
         void db::reset_data(){
             data = first =
             last = anchor = nullptr;
+            length = 0;
+            if(index) {delete index; index = nullptr;}
             file.close();
         }
         
         void db::erase(){
-            erase_bits(first);
+            std::unique_lock<std::shared_mutex> lock = write_lock(false);
+            log(journal_erase, nullptr);
+            release_bits();
             reset_data();
         }
         
+        lan::db_arena_stats db::allocator_stats() const {
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            return arena.stats();
+        }
+        
+        lan::db_stats db::stats() const {
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            return {counters.pulls, counters.read_ns, counters.parse_ns, counters.pushes, counters.serialize_ns, counters.write_ns,
+                counters.lookups, counters.visited, arena.stats().allocations - counters.allocations, counters.exceptions};
+        }
+        
+        void db::reset_stats(){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            for(std::atomic<uint64_t> * counter : {&counters.pulls, &counters.read_ns, &counters.parse_ns, &counters.pushes, &counters.serialize_ns,
+                &counters.write_ns, &counters.lookups, &counters.visited, &counters.exceptions})
+                *counter = 0;
+            counters.allocations = arena.stats().allocations;
+        }
+        
+        void db::set_concurrent(bool enabled){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            if((concurrent = enabled)){
+                expand_all();
+                prepare_lookups(first);
+            }
+        }
+        
+        std::shared_ptr<lan::db> db::snapshot(){
+            std::shared_ptr<lan::db> copy;
+            if(frozen){
+                // a snapshot never changes, its copy is made once and kept while held
+                std::lock_guard<std::mutex> guard(snapshot_guard);
+                if((copy = last_snapshot.lock())) return copy;
+                copy = std::make_shared<lan::db>();
+                copy->format = format;
+                copy->indexing = indexing;
+                copy->generation = generation;
+                copy->first = copy->copy_bits(*this, first, nullptr);
+                copy->get_tail(nullptr);
+                copy->prepare_lookups(copy->first);
+                copy->frozen = true;
+                last_snapshot = copy;
+                return copy;
+            }
+            // the view borrows the bits with exclusive access: lazy text is expanded first, and no reader is building lookups
+            std::unique_lock<std::shared_mutex> lock = exclusive_lock();
+            if((copy = last_snapshot.lock()) and copy->generation == generation)
+                return copy;
+            if(not pending.empty()) expand_all();
+            copy = std::make_shared<lan::db>();
+            copy->format = format;
+            copy->indexing = indexing;
+            copy->threads = threads;
+            copy->generation = generation;
+            copy->first = first;
+            copy->last = last;
+            copy->length = length;
+            copy->anchor = anchor;
+            copy->index = index;
+            copy->frozen = true;
+            last_snapshot = copy;
+            shared = true;
+            return copy;
+        }
+        
+        void db::unshare(bool keep){
+            std::shared_ptr<lan::db> view = last_snapshot.lock();
+            uint64_t allocations = arena.stats().allocations;
+            shared = false;
+            if(not view) return;
+            if(not keep) drop_unsafe(first);
+            view->retained.reset(new lan::db_arena);
+            view->retained->merge(arena);
+            counters.allocations -= allocations;
+            restructure();
+            data = first = last = anchor = nullptr;
+            length = 0;
+            index = nullptr;
+            if(keep){
+                first = copy_bits(*view, view->first, nullptr, true);
+                get_tail(nullptr);
+            }
+        }
+        
+        lan::db_bits * db::copy_bits(lan::db & origin, lan::db_bits * bits, lan::db_bit * context, bool adopt){
+            lan::db_bit * head = nullptr, * tail = nullptr, * bit;
+            for( ; bits ; bits = bits->nex){
+                bit = arena.make_bit();
+                bit->key = bits->key;
+                bit->type = bits->type;
+                bit->con = context;
+                if(bits->type >= Array) bit->lin = copy_bits(origin, origin.expand(bits), bit, adopt);
+                else if(bits->type == Unsafe and adopt and bits->inlined()) {bit->value = bits->value; bit->data = &bit->value;}
+                else if(bits->type == Unsafe and adopt and bits->data) bit->data = arena.adopt(*origin.retained, bits->data);
+                else if(bits->type != Unsafe and bits->data) copy_data(bit, bits);
+                if(bits == origin.anchor) anchor = bit;
+                if((bit->pre = tail)) tail->nex = bit;
+                else head = bit;
+                tail = bit;
+            } return head;
+        }
+        
+        void db::drop_unsafe(lan::db_bits * bits){
+            for( ; bits ; bits = bits->nex){
+                if(bits->type == Unsafe and bits->data and not bits->inlined()) arena.drop(bits->data);
+                if(bits->lin) drop_unsafe(bits->lin);
+            }
+        }
+        
+        void db::prepare_lookups(lan::db_bits * bits, lan::db_bit * context){
+            size_t count = 0;
+            for(lan::db_bit * buffer = bits ; buffer ; buffer = buffer->nex, count++){
+                if(buffer->type == Array) get_array_items(buffer);
+                if(buffer->type >= Array) prepare_lookups(expand(buffer), buffer);
+            } get_tail(context);
+            if(indexing and count >= db_index_threshold and not get_context_index(context) and (not context or context->type == Container))
+                build_context_index(context);
+        }
+        
+        void db::set_indexing(bool enabled){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            if(not (indexing = enabled)){
+                if(index) {delete index; index = nullptr;}
+                drop_indexes(first);
+            }
+        }
+        
         bool db::empty(){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
             return (not last);
         }
         
-        void db::print(size_t tabs, lan::db_bit * bits){
-            lan::db_bit * buffer = (bits) ? bits : first;
-            while (buffer) {
-                for(register_t i=0;i<tabs;i++)printf("\t");
+        void db::print(size_t tabs, lan::db_bit * bits, bool sizes){
+            std::vector<std::string> lines;
+            print_bits(tabs, (bits) ? bits : first, sizes, lines);
+            for(std::string const & line : lines)
+                printf("%s\n", line.data());
+        }
+        
+        std::pair<size_t, size_t> db::print_bits(size_t tabs, lan::db_bit * bits, bool sizes, std::vector<std::string> & lines){
+            std::pair<size_t, size_t> listed (0, 0);
+            char number [64];
+            for(lan::db_bit * buffer = bits ; buffer ; buffer = buffer->nex){
+                // the line of a context is completed with the sizes its bits return
+                size_t line = lines.size();
+                std::pair<size_t, size_t> measured (0, 0);
+                lan::db_memory_usage usage = {};
+                lines.emplace_back(tabs, '\t');
                 if(buffer->type < Array){
-                    printf("| %s %d 0x%llx\n", buffer->key.data(), buffer->type, (long long)buffer->data);
-                } else {
-                    if(buffer->type == Array)
-                        printf("[ %s ]:\n", buffer->key.data());
-                    else printf("( %s ):\n", buffer->key.data());
-                    if(buffer->lin)print(tabs+1, buffer->lin);
-                } buffer = buffer->nex;
-            }
+                    snprintf(number, sizeof(number), " %d 0x%llx", buffer->type, (long long)buffer->data);
+                    lines[line] += "| " + buffer->key + number;
+                } else lines[line] += (buffer->type == Array) ? "[ " + buffer->key + " ]:" : "( " + buffer->key + " ):";
+                if(buffer->type >= Array and expand(buffer)) measured = print_bits(tabs + 1, buffer->lin, sizes, lines);
+                if(sizes){
+                    measure(buffer, usage, false);
+                    measured.first += usage.overall.total();
+                    measured.second += usage.overall.bits;
+                    snprintf(number, sizeof(number), " %zu bytes (%zu bits)", measured.first, measured.second);
+                    lines[line] += number;
+                } listed.first += measured.first;
+                listed.second += measured.second;
+            } return listed;
+        }
+        
+        /* memory */
+        
+        /* Estimates the bytes of a hash index (nodes with a cached hash, and buckets). */
+        static size_t index_size(lan::db_index const * index){
+            return index->size() * (sizeof(lan::db_index::value_type) + 2 * sizeof(void*)) + index->bucket_count() * sizeof(void*);
+        }
+        
+        void db::measure(lan::db_bit const * bit, lan::db_memory_usage & usage, bool deep) const {
+            static const size_t small_string = std::string().capacity();
+            size_t key = (bit->key.capacity() > small_string) ? bit->key.capacity() + 1 : 0, payload = 0, string = 0, lookups = 0, text = 0;
+            std::unordered_map<lan::db_bit *, std::string_view>::const_iterator entry;
+            if(bit->data and not bit->inlined() and not (frozen and bit->type == Unsafe)) payload = db_arena::size_of(bit->data);
+            if(bit->type == String and bit->data and ((std::string*)bit->data)->capacity() > small_string)
+                string = ((std::string*)bit->data)->capacity() + 1;
+            if(bit->index) lookups += index_size(bit->index);
+            if(bit->items) lookups += sizeof(lan::db_array) + bit->items->capacity() * sizeof(lan::db_bit *);
+            if(bit->pending and (entry = pending.find((lan::db_bit *)bit)) != pending.end()) text = entry->second.length();
+            for(lan::db_memory * memory : {&usage.overall, &usage.types[bit->type]}){
+                memory->bits++;
+                memory->nodes += sizeof(lan::db_bit);
+                memory->keys += key;
+                memory->payloads += payload;
+                memory->strings += string;
+                memory->lookups += lookups;
+                memory->pending += text;
+            } if(deep and not bit->pending)
+                for(lan::db_bit const * buffer = bit->lin ; buffer ; buffer = buffer->nex)
+                    measure(buffer, usage);
+        }
+        
+        lan::db_memory_usage db::memory_usage(std::string_view const name){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            lan::db_memory_usage usage = {};
+            lan::db_bit * context = search_list(name);
+            if(context) measure(context, usage);
+            else {
+                for(lan::db_bit const * buffer = first ; buffer ; buffer = buffer->nex)
+                    measure(buffer, usage);
+                if(index) usage.overall.lookups += index_size(index);
+            } return usage;
         }
         
         /* file */
         
         bool db::connect(std::string filename){
+            return connect(filename, format_of(filename));
+        }
+        
+        bool db::connect(std::string filename, lan::db_format format){
+            std::unique_lock<std::shared_mutex> lock = exclusive_lock();
+            this->format = format;
+            journal.clear();
+            if(journaling) journal_file.assign(filename + ".journal");
             return file.open(filename);
         }
         
+        lan::db_format db::format_of(std::string const filename){
+            size_t length = filename.length();
+            return (length > 5 and filename.compare(length - 5, 5, ".ldbb") == 0) ? Binary : Text;
+        }
+        
+        bool db::convert(std::string const source, std::string const target){
+            lan::db database;
+            struct stat status;
+            bool empty;
+            if(stat(source.data(), &status) != 0 or not database.connect(source)) return false;
+            empty = status.st_size == 0 or (format_of(source) == Binary and (size_t)status.st_size == db_binary_magic.length());
+            if(not database.pull() and not empty) return false;
+            return database.connect(target) and database.push();
+        }
+        
         bool db::is_connected(){
             return file.check();
         }
         
         bool db::disconnect(){
+            std::unique_lock<std::shared_mutex> lock = exclusive_lock();
+            journal.clear();
+            journal_file.close();
             return file.close();
         }
         
@@ -225,7 +1036,8 @@ namespace lan
                 switch(type){
                     case Container: bit = read_container_bit(content, true); break;
                     default: bit = read_value_bit(content, true); break;
-                } bit->nex = (bit) ? get_array_data(content) : nullptr;
+                } if((bit->nex = (bit) ? get_array_data(content) : nullptr))
+                    bit->nex->pre = bit;
             } return bit;
         }
         
@@ -233,25 +1045,29 @@ namespace lan
             db_bit * bit = nullptr, * f_bit = nullptr;
             if((bit = read_bit(content))){
                 f_bit = bit;
-                while((bit->nex = read_bit(content)))
+                while((bit->nex = read_bit(content))){
+                    bit->nex->pre = bit;
                     bit = bit -> nex;
+                }
             } return f_bit;
         }
         
         lan::db_bit * db::read_container_bit(std::string & content, bool in_array){
-            db_bit * bit = new db_bit;
+            db_bit * bit = arena.make_bit();
             if(!in_array)
                 bit->key = pop_next(content);
             bit->type = Container;
             if(pop_next(content) == ":") {
                 bit->lin = get_container_data(content);
+                for(db_bit * buffer = bit->lin ; buffer ; buffer = buffer->nex)
+                    buffer->con = bit;
             } else {
                 throw lan::errors::pull_error ("LANDB (pull_error): unable read container <" + bit->key + ">, the param <:> was not found.");
             } return bit;
         }
         
         lan::db_bit * db::read_array_bit(std::string const name, std::string & content){
-            db_bit * bit = new db_bit;
+            db_bit * bit = arena.make_bit();
             bit->key = name;
             bit->type = Array;
             bit->data = nullptr;
@@ -259,6 +1075,8 @@ namespace lan
                 throw lan::errors::pull_error ("LANDB (pull_error): landb: expected <[> before <" + pop_next(content) + "> ... " + pop_next(content));
             else
                 bit->lin = get_array_data(content);
+            for(db_bit * buffer = bit->lin ; buffer ; buffer = buffer->nex)
+                buffer->con = bit;
             return bit;
         }
         
@@ -270,16 +1088,16 @@ namespace lan
                 return Unsafe;
         }
 
-        void * db::get_var_data(db_bit_type type, std::string data){
-            switch(type){
-                case Bool: return new bool(atoi(data.data())); break;
-                case Int:  return new int(atoi(data.data())); break;
-                case Long: return new long(atol(data.data())); break;
-                case LongLong: return new long long(atoll(data.data())); break;
-                case Float: return new float(atof(data.data())); break;
-                case Double: return new double(strtod(data.data(), nullptr));
-                case Char: return new char(prepare_string_to_read(data.substr(1, data.length()-2))[0]);       break;
-                case String: return new std::string(prepare_string_to_read(data.substr(1, data.length()-2))); break;
+        void * db::get_var_data(db_bit * bit, std::string data){
+            switch(bit->type){
+                case Bool: return set_data<bool>(bit, read_number<int>(data)); break;
+                case Int:  return set_data<int>(bit, read_number<int>(data)); break;
+                case Long: return set_data<long>(bit, read_number<long>(data)); break;
+                case LongLong: return set_data<long long>(bit, read_number<long long>(data)); break;
+                case Float: return set_data<float>(bit, read_number<float>(data)); break;
+                case Double: return set_data<double>(bit, read_number<double>(data));
+                case Char: return set_data<char>(bit, prepare_string_to_read(data.substr(1, data.length()-2))[0]);       break;
+                case String: return set_data<std::string>(bit, prepare_string_to_read(data.substr(1, data.length()-2))); break;
                 default: return nullptr;
             }
         }
@@ -297,10 +1115,10 @@ namespace lan
         }
         
         lan::db_bit * db::read_var_bit(std::string name, db_bit_type type , std::string & content){
-            db_bit * bit = new db_bit;
+            db_bit * bit = arena.make_bit();
             bit->key = name;
             bit->type=type;
-            bit->data = get_var_data(type, pop_next(content));
+            get_var_data(bit, pop_next(content));
             return bit;
         }
         
@@ -340,37 +1158,574 @@ namespace lan
             db_bit * bit = nullptr, * f_bit;
             f_bit = bit = read_bit(content);
             while(bit) {
-                bit->nex = read_bit(content);
+                if((bit->nex = read_bit(content)))
+                    bit->nex->pre = bit;
                 bit = bit->nex;
             } return f_bit;
         }
         
+        std::string & db::prepare_string_to_read(std::string_view src, std::string & dst){
+            size_t start = 0, end;
+            dst.clear();
+            dst.reserve(src.length());
+            while((end = db_scanner::quote(src, start)) < src.length()){
+                dst.append(src.substr(start, end - start));
+                if(src[end] == '\\' and ++end >= src.length()) return dst;
+                dst += src[end];
+                start = end + 1;
+            } return dst.append(src.substr(start));
+        }
+        
+        void * db::read_var_data(db_bit * bit, std::string_view data){
+            std::string string;
+            if(bit->type == Char or bit->type == String){
+                if(data.length() < 2 or data.front() != '"' or data.back() != '"')
+                    throw lan::errors::pull_error ("LANDB (pull_error): unable to read value bit <" + bit->key + ">, expected a quoted value.");
+                prepare_string_to_read(data.substr(1, data.length()-2), string);
+            } switch(bit->type){
+                case Bool: return set_data<bool>(bit, read_number<int>(data)); break;
+                case Int:  return set_data<int>(bit, read_number<int>(data)); break;
+                case Long: return set_data<long>(bit, read_number<long>(data)); break;
+                case LongLong: return set_data<long long>(bit, read_number<long long>(data)); break;
+                case Float: return set_data<float>(bit, read_number<float>(data)); break;
+                case Double: return set_data<double>(bit, read_number<double>(data)); break;
+                case Char: return set_data<char>(bit, string[0]); break;
+                case String: return set_data<std::string>(bit, std::move(string)); break;
+                default: return nullptr;
+            }
+        }
+        
+        lan::db_bits * db::parse_bits(lan::db_cursor & cursor, lan::db_bit * context){
+            db_bit * bit = nullptr, * f_bit = nullptr, * l_bit = nullptr;
+            try {
+                while((bit = parse_bit(cursor))){
+                    bit->con = context;
+                    if((bit->pre = l_bit)) l_bit->nex = bit;
+                    else f_bit = bit;
+                    l_bit = bit;
+                }
+            } catch(...) {
+                erase_bits(f_bit);
+                throw;
+            } return f_bit;
+        }
+        
+        lan::db_bit * db::parse_container_bit(lan::db_cursor & cursor, bool in_array){
+            db_bit * bit = arena.make_bit();
+            if(!in_array)
+                bit->key = cursor.next();
+            bit->type = Container;
+            if(cursor.next() == ":") {
+                try {
+                    if(lazy) parse_pending(cursor, bit);
+                    else bit->lin = parse_bits(cursor, bit);
+                } catch(...) {
+                    arena.release_bit(bit);
+                    throw;
+                }
+            } else {
+                std::string key = bit->key;
+                arena.release_bit(bit);
+                throw lan::errors::pull_error ("LANDB (pull_error): unable read container <" + key + ">, the param <:> was not found.");
+            } return bit;
+        }
+        
+        lan::db_bit * db::parse_array_bit(std::string_view name, lan::db_cursor & cursor){
+            db_bit * bit = nullptr;
+            std::string_view token;
+            if((token = cursor.next()) != "[")
+                throw lan::errors::pull_error ("LANDB (pull_error): landb: expected <[> before <" + std::string(token) + "> ... " + std::string(cursor.peek()));
+            bit = arena.make_bit();
+            bit->key = name;
+            bit->type = Array;
+            try {
+                if(lazy) parse_pending(cursor, bit);
+                else bit->lin = parse_array_data(cursor, bit);
+            } catch(...) {
+                arena.release_bit(bit);
+                throw;
+            } return bit;
+        }
+        
+        lan::db_bits * db::parse_array_data(lan::db_cursor & cursor, lan::db_bit * array){
+            db_bit * buffer = nullptr, * f_bit = nullptr, * l_bit = nullptr;
+            std::string_view token;
+            try {
+                while((token = cursor.peek()).length()){
+                    if(token == "]") {cursor.next(); break;}
+                    else if(token == "(") {cursor.next(); buffer = parse_container_bit(cursor, true);}
+                    else if(convert_to_bit_type(token[0]) != Unsafe) buffer = parse_value_bit(cursor, true);
+                    else break;
+                    if(not buffer) break;
+                    buffer->con = array;
+                    if((buffer->pre = l_bit)) l_bit->nex = buffer;
+                    else f_bit = buffer;
+                    l_bit = buffer;
+                }
+            } catch(...) {
+                erase_bits(f_bit);
+                throw;
+            } return f_bit;
+        }
+        
+        void db::parse_pending(lan::db_cursor & cursor, lan::db_bit * bit){
+            pending[bit] = cursor.skip_block();
+            bit->pending = true;
+        }
+        
+        lan::db_bit * db::parse_value_bit(lan::db_cursor & cursor, bool in_array){
+            std::string_view name, type_str;
+            db_bit_type type = Unsafe;
+            lan::db_bit * bit = nullptr;
+            if(!in_array and !((name = cursor.next()).length() and (cursor.next() == "="))){
+                throw lan::errors::pull_error ("LANDB (pull_error): unable read value bit <" + std::string(name) + ">, invalid sintax.");
+            } if((type_str = cursor.next()).length() and (cursor.next() == ":")){
+                type = convert_to_bit_type(type_str[0]);
+                if(type == Array) {
+                    bit = parse_array_bit(name, cursor);
+                } else {
+                    bit = arena.make_bit();
+                    bit->key = name;
+                    bit->type = type;
+                    try {
+                        read_var_data(bit, cursor.next());
+                    } catch(...) {
+                        arena.release_bit(bit);
+                        throw;
+                    }
+                }
+            } return bit;
+        }
+        
+        lan::db_bit * db::parse_bit(lan::db_cursor & cursor){
+            std::string_view token = cursor.peek();
+            if(token.empty()) return nullptr;
+            else if(token == "(") {
+                cursor.next();
+                return parse_container_bit(cursor);
+            } else if(token == "]" or token == ")") {
+                cursor.next();
+                return nullptr;
+            } return parse_value_bit(cursor);
+        }
+        
+        lan::db_bits * db::parse_all_bits(std::string_view content){
+            db_cursor cursor(content);
+            return parse_bits(cursor);
+        }
+        
+        size_t db::split_point(std::string_view content, size_t from, size_t to){
+            size_t before, after;
+            for(size_t p = from ; p < to ; p++){
+                if(db_chars.table[(unsigned char)content[p]] != _blank) continue;
+                // the blanks inside of a value bit touch its <=> or <:>
+                for(before = p ; before and db_chars.table[(unsigned char)content[before - 1]] == _blank ; before--);
+                if((after = db_scanner::non_blank(content, p)) >= content.length()) return std::string_view::npos;
+                if(before and content[before - 1] != '=' and content[before - 1] != ':' and
+                   ((after < to and content[after] != '=' and content[after] != ':') or content[after] == '('))
+                    return after;
+                p = after;
+            } return std::string_view::npos;
+        }
+        
+        bool db::read_list_header(std::string_view content, size_t from, size_t at, bool in_array, lan::db_pull_task & task, size_t & start, size_t & offset){
+            size_t p = at;
+            task = {std::string_view(), std::string_view(), Container, std::string_view::npos, nullptr, nullptr, 0};
+            if(content[at] == '('){
+                db_cursor cursor(content.substr(at + 1));
+                std::string_view token = cursor.next();
+                if(not in_array and (token.empty() or db_chars.table[(unsigned char)token[0]] == _single or cursor.next() != ":")) return false;
+                if(in_array and token != ":") return false;
+                task.key = (in_array) ? std::string_view() : token;
+                start = at;
+                offset = at + 1 + cursor.position();
+                return true;
+            } task.type = Array;
+            // <key=a:[> or <a:[> in an array, read backwards from the bracket
+            auto skip = [&](){ while(p > from and db_chars.table[(unsigned char)content[p - 1]] == _blank) p--; };
+            skip();
+            if(p <= from or content[--p] != ':') return false;
+            skip();
+            if(p <= from or content[--p] != 'a' or (p > from and db_chars.table[(unsigned char)content[p - 1]] == _other)) return false;
+            offset = at + 1;
+            if(in_array) {start = p; return true;}
+            skip();
+            if(p <= from or content[--p] != '=') return false;
+            skip();
+            for(start = p ; start > from and db_chars.table[(unsigned char)content[start - 1]] == _other and content[start - 1] != '"' ; start--);
+            task.key = content.substr(start, p - start);
+            return task.key.length();
+        }
+        
+        bool db::plan_pull(std::string_view content, size_t & offset, size_t parent, size_t size, std::vector<lan::db_pull_task> & plan){
+            size_t block = offset, next, cut, mark, start;
+            bool in_array = parent != std::string_view::npos and plan[parent].type == Array;
+            char close = (parent == std::string_view::npos) ? 0 : (in_array) ? ']' : ')';
+            lan::db_pull_task task;
+            auto push_block = [&](size_t end){
+                if(content.substr(block, end - block).find_first_not_of(" \t\r\n") != std::string_view::npos)
+                    plan.push_back({content.substr(block, end - block), std::string_view(), Unsafe, parent, nullptr, nullptr, 0});
+                block = end;
+            };
+            while(true){
+                next = db_scanner::bracket(content, offset);
+                while(next - block >= size and (cut = split_point(content, std::max(offset, block + size), next)) != std::string_view::npos)
+                    push_block(offset = cut);
+                if(next >= content.length()){
+                    if(close) return false;
+                    push_block(offset = content.length());
+                    return true;
+                } switch(content[next]){
+                    case '"':
+                        if((offset = db_cursor::string_end(content, next + 1) + 1) > content.length()) return false;
+                        break;
+                    case '(': case '[':
+                        if(not read_list_header(content, block, next, in_array, task, start, offset)) return false;
+                        mark = plan.size();
+                        cut = block;
+                        push_block(start);
+                        task.parent = parent;
+                        plan.push_back(task);
+                        if(not plan_pull(content, offset, plan.size() - 1, size, plan)) return false;
+                        if(offset - start < size){
+                            // small enough to stay in the block
+                            plan.resize(mark);
+                            block = cut;
+                        } else block = offset;
+                        break;
+                    default:
+                        if(content[next] != close) return false;
+                        push_block(next);
+                        offset = next + 1;
+                        return true;
+                } if(offset - block >= size) push_block(offset);
+            }
+        }
+        
+        void db::parse_block(lan::db_pull_task & task, lan::db_bit * context){
+            db_cursor cursor(task.text);
+            task.head = (context and context->type == Array) ? parse_array_data(cursor, context) : parse_bits(cursor, context);
+            if(cursor.peek().length()){
+                erase_bits(task.head);
+                task.head = nullptr;
+                throw lan::errors::pull_error ("LANDB (pull_error): unexpected <" + std::string(cursor.peek()) + ">.");
+            } for(task.tail = task.head, task.count = (task.head) ? 1 : 0 ; task.tail and task.tail->nex ; task.count++)
+                task.tail = task.tail->nex;
+        }
+        
+        lan::db_bits * db::parse_all_bits(std::string_view content, size_t threads){
+            std::vector<lan::db_pull_task> plan;
+            std::vector<size_t> blocks;
+            std::vector<std::exception_ptr> failures (threads);
+            std::vector<std::unique_ptr<lan::db>> workers;
+            std::vector<std::thread> pool;
+            std::atomic<size_t> next (0);
+            lan::db_bit * bits = nullptr, * tail = nullptr, * context;
+            size_t offset = 0;
+            if(threads < 2 or content.length() < 2 * db_parallel_block_size)
+                return parse_all_bits(content);
+            if(not plan_pull(content, offset, std::string_view::npos, std::max(db_parallel_block_size, content.length() / (threads * 4)), plan) or plan.size() < 2)
+                return parse_all_bits(content);
+            // the arrays and containers split across blocks are made first, the threads link their bits to them
+            for(size_t i = 0 ; i < plan.size() ; i++){
+                if(plan[i].type == Unsafe) {blocks.push_back(i); continue;}
+                plan[i].head = arena.make_bit();
+                plan[i].head->key = plan[i].key;
+                plan[i].head->type = plan[i].type;
+            } threads = std::min(threads, blocks.size());
+            for(size_t t = 0 ; t < threads ; t++)
+                workers.emplace_back(new lan::db);
+            for(size_t t = 0 ; t < threads ; t++){
+                pool.emplace_back([&, t](){
+                    try {
+                        for(size_t block ; (block = next++) < blocks.size() ; ){
+                            lan::db_pull_task & task = plan[blocks[block]];
+                            workers[t]->parse_block(task, (task.parent != std::string_view::npos) ? plan[task.parent].head : nullptr);
+                        }
+                    } catch (...) {
+                        failures[t] = std::current_exception();
+                        next = blocks.size();
+                    }
+                });
+            } for(std::thread & worker : pool)
+                worker.join();
+            for(size_t t = 0 ; t < threads ; t++)
+                arena.merge(workers[t]->arena);
+            for(lan::db_pull_task & task : plan){
+                lan::db_bit * head = task.head, * last = (task.type == Unsafe) ? task.tail : task.head;
+                if(not head) continue;
+                if(task.parent == std::string_view::npos){
+                    if((head->pre = tail)) tail->nex = head;
+                    else bits = head;
+                    tail = last;
+                } else {
+                    context = plan[task.parent].head;
+                    head->con = context;
+                    if((head->pre = context->tail)) context->tail->nex = head;
+                    else context->lin = head;
+                    context->tail = last;
+                    context->count += (task.type == Unsafe) ? task.count : 1;
+                }
+            } for(std::exception_ptr & error : failures){
+                if(not error) continue;
+                erase_bits(bits);
+                try {
+                    std::rethrow_exception(error);
+                } catch (lan::errors::pull_error &) {
+                    // a block that doesn't parse on its own: one thread reports the error (or parses what the split got wrong)
+                    return parse_all_bits(content);
+                }
+            } return bits;
+        }
+        
+        uint64_t db::read_varint(std::string_view content, size_t & offset){
+            uint64_t value = 0;
+            for(size_t shift = 0 ; offset < content.length() and shift < 64 ; shift += 7){
+                unsigned char byte = content[offset++];
+                value |= (uint64_t)(byte & 0x7f) << shift;
+                if(not (byte & 0x80)) return value;
+            } throw lan::errors::pull_error ("LANDB (pull_error): truncated binary number at " + std::to_string(offset) + ".");
+        }
+        
+        std::string_view db::read_binary_string(std::string_view content, size_t & offset){
+            uint64_t length = read_varint(content, offset);
+            if(length > content.length() - offset)
+                throw lan::errors::pull_error ("LANDB (pull_error): truncated binary string at " + std::to_string(offset) + ".");
+            offset += length;
+            return content.substr(offset - length, length);
+        }
+        
+        uint64_t db::read_fixed(std::string_view content, size_t & offset, size_t bytes){
+            uint64_t value = 0;
+            if(bytes > content.length() - offset)
+                throw lan::errors::pull_error ("LANDB (pull_error): truncated binary value at " + std::to_string(offset) + ".");
+            for(size_t i = 0 ; i < bytes ; i++)
+                value |= (uint64_t)(unsigned char)content[offset++] << (8*i);
+            return value;
+        }
+        
+        lan::db_bit * db::parse_binary_bit(std::string_view content, size_t & offset){
+            lan::db_bit * bit;
+            unsigned char type;
+            uint64_t value;
+            uint32_t raw_f;
+            float f;
+            double d;
+            if(offset >= content.length() or (type = content[offset]) == db_binary_end) return nullptr;
+            if(type > Container or type == Unsafe)
+                throw lan::errors::pull_error ("LANDB (pull_error): invalid binary type <" + std::to_string(type) + "> at " + std::to_string(offset) + ".");
+            offset++;
+            bit = arena.make_bit();
+            bit->type = (db_bit_type)type;
+            try {
+                bit->key = read_binary_string(content, offset);
+                switch(bit->type){
+                    case Bool:      set_data<bool>(bit, read_fixed(content, offset, 1)); break;
+                    case Int:       value = read_varint(content, offset); set_data<int>(bit, (int)((value >> 1) ^ -(value & 1))); break;
+                    case Long:      value = read_varint(content, offset); set_data<long>(bit, (long)((value >> 1) ^ -(value & 1))); break;
+                    case LongLong:  value = read_varint(content, offset); set_data<long long>(bit, (long long)((value >> 1) ^ -(value & 1))); break;
+                    case Float:     raw_f = read_fixed(content, offset, 4); memcpy(&f, &raw_f, 4); set_data<float>(bit, f); break;
+                    case Double:    value = read_fixed(content, offset, 8); memcpy(&d, &value, 8); set_data<double>(bit, d); break;
+                    case Char:      set_data<char>(bit, (char)read_fixed(content, offset, 1)); break;
+                    case String:    set_data<std::string>(bit, std::string(read_binary_string(content, offset))); break;
+                    default:
+                        bit->lin = parse_binary_bits(content, offset, bit);
+                        if(offset >= content.length() or (unsigned char)content[offset++] != db_binary_end)
+                            throw lan::errors::pull_error ("LANDB (pull_error): unable to read binary " + std::string((bit->type == Array) ? "array" : "container") + " <" + bit->key + ">, the end was not found.");
+                        break;
+                }
+            } catch(...) {
+                erase_bits(bit->lin);
+                bit->lin = nullptr;
+                arena.release_bit(bit);
+                throw;
+            } return bit;
+        }
+        
+        lan::db_bits * db::parse_binary_bits(std::string_view content, size_t & offset, lan::db_bit * context){
+            db_bit * bit = nullptr, * f_bit = nullptr, * l_bit = nullptr;
+            try {
+                while((bit = parse_binary_bit(content, offset))){
+                    bit->con = context;
+                    if((bit->pre = l_bit)) l_bit->nex = bit;
+                    else f_bit = bit;
+                    l_bit = bit;
+                }
+            } catch(...) {
+                erase_bits(f_bit);
+                throw;
+            } return f_bit;
+        }
+        
+        lan::db_bits * db::parse_all_binary_bits(std::string_view content){
+            size_t offset = db_binary_magic.length();
+            db_bits * bits;
+            if(content.empty()) return nullptr;
+            if(content.substr(0, offset) != db_binary_magic)
+                throw lan::errors::pull_error ("LANDB (pull_error): invalid binary database, the magic number was not found.");
+            bits = parse_binary_bits(content, offset);
+            if(offset != content.length()){
+                erase_bits(bits);
+                throw lan::errors::pull_error ("LANDB (pull_error): unexpected end of binary bits at " + std::to_string(offset) + ".");
+            } return bits;
+        }
+        
+        void db::set_lazy(bool enabled){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            if(not (lazy = enabled))
+                expand_all();
+        }
+        
+        void db::set_threads(size_t threads){
+            std::unique_lock<std::shared_mutex> lock = exclusive_lock();
+            this->threads = (threads) ? threads : std::max(1u, std::thread::hardware_concurrency());
+        }
+        
+        void db::expand_pending(lan::db_bit * bit){
+            std::unordered_map<lan::db_bit *, std::string_view>::iterator block = pending.find(bit);
+            db_cursor cursor((block != pending.end()) ? block->second : std::string_view());
+            // the block stays pending until it parses, a failed parse erased its partial bits already
+            lan::db_bits * bits = (bit->type == Array) ? parse_array_data(cursor, bit) : parse_bits(cursor, bit);
+            bit->lin = bits;
+            drop_pending(bit);
+        }
+        
+        void db::expand_all(lan::db_bits * bits){
+            for(bits = (bits) ? bits : first ; bits ; bits = bits->nex)
+                if(bits->type >= Array and expand(bits)) expand_all(bits->lin);
+        }
+        
+        void db::drop_pending(lan::db_bit * bit){
+            pending.erase(bit);
+            bit->pending = false;
+            if(pending.empty()) std::string().swap(source);
+        }
+        
         bool db::pull(){
-            if(first)
-                erase_bits(first);
-            first = nullptr;
-            std::string data_str = file.pull(); 
-            return (first = read_all_bits(data_str));
+            std::unique_lock<std::shared_mutex> lock = write_lock(false);
+            release_bits();
+            LANDB_COUNT(pulls, 1);
+            try {
+                std::string_view content;
+                {
+                    LANDB_TIME(read_ns);
+                    content = (format != Binary and lazy) ? std::string_view(source = file.pull()) : file.view();
+                }
+                LANDB_TIME(parse_ns);
+                if(format == Binary) first = parse_all_binary_bits(content);
+                else if(lazy) first = parse_all_bits(content);
+                else first = parse_all_bits(content, threads);
+            } catch (...) {
+                LANDB_COUNT(exceptions, 1);
+                file.unmap();
+                throw;
+            } file.unmap();
+            get_tail(nullptr);
+            journal.clear();
+            if(journaling){
+                try {
+                    std::string_view content;
+                    {
+                        LANDB_TIME(read_ns);
+                        content = journal_file.view();
+                    }
+                    LANDB_TIME(parse_ns);
+                    replay(content);
+                } catch (...) {
+                    LANDB_COUNT(exceptions, 1);
+                    journal_file.unmap();
+                    throw;
+                } journal_file.unmap();
+            } if(concurrent){
+                expand_all();
+                prepare_lookups(first);
+            }
+            return (first) and update_last();
         }
         
-        std::string db::write_container_bit(db_bit * bits){
-            db_bit * buffer = bits->lin;
-            std::string bits_str = '(' + bits->key + ": ";
+        bool db::write_pending(db_bit * bit, lan::db_sink & sink){
+            std::unordered_map<lan::db_bit *, std::string_view>::iterator block;
+            if(not bit->pending or (block = pending.find(bit)) == pending.end()) return false;
+            if(bit->type != Array) sink.put('(').write(bit->key).put(':');
+            else if(bit->key.length()) sink.write(bit->key).write("=a:[");
+            else sink.write("a:[");
+            sink.write(block->second);
+            return true;
+        }
+        
+        void db::write_container_bit(db_bit * bits, lan::db_sink & sink){
+            if(write_pending(bits, sink)) return;
+            db_bit * buffer = expand(bits);
+            sink.put('(').write(bits->key).write(": ");
             while(buffer){
-                bits_str += write_bit(buffer);
+                write_bit(buffer, sink);
                 buffer = buffer->nex;
-            } bits_str += ')';
-            return bits_str;
+            } sink.put(')');
         }
         
-        std::string db::write_array_bit(db_bit * bits){
-            db_bit * buffer = bits->lin;
-            std::string bits_str = ((bits->key.length()) ? bits->key + "=" : "") + "a:[";
+        void db::write_array_bit(db_bit * bits, lan::db_sink & sink){
+            if(write_pending(bits, sink)) return;
+            db_bit * buffer = expand(bits);
+            if(bits->key.length()) sink.write(bits->key).put('=');
+            sink.write("a:[");
             while(buffer){
-                bits_str += write_bit(buffer, true);
+                write_bit(buffer, sink, true);
                 buffer = buffer->nex;
-                if(buffer)bits_str += (' ');
-            } bits_str += "]";
+                if(buffer) sink.put(' ');
+            } sink.put(']');
+        }
+        
+        void db::prepare_string_to_write(std::string_view src, lan::db_sink & sink){
+            size_t start = 0, end = 0;
+            while((end = db_scanner::quote(src, end)) < src.length()){
+                sink.write(src.substr(start, end - start)).put('\\');
+                start = end++;
+            } sink.write(src.substr(start));
+        }
+        
+        void db::write_var_bit(db_bit * bit, lan::db_sink & sink, bool in_array){
+            if(!bit->data) return;
+            if(bit->type > String) {sink.put(' '); return;}
+            sink.write(bit->key).put((!in_array) ? '=' : ' ').put(db_bit_table [bit->type]).put(':');
+            switch (bit->type) {
+                case Bool:      write_number<int>(get<bool>(bit), sink);   break;
+                case Int:       write_number(get<int>(bit), sink);         break;
+                case Long:      write_number(get<long>(bit), sink);        break;
+                case LongLong:  write_number(get<long long>(bit), sink);   break;
+                case Float:     write_number(get<float>(bit), sink);       break;
+                case Double:    write_number(get<double>(bit), sink);      break;
+                case Char:      sink.put('"'); prepare_string_to_write(std::string_view(&bit->value.c, 1), sink); sink.put('"'); break;
+                case String:    sink.put('"'); prepare_string_to_write(*(std::string*)bit->data, sink); sink.put('"'); break;
+                default:        break;
+            } sink.put(' ');
+        }
+        
+        void db::write_bit(db_bit * bit, lan::db_sink & sink, bool in_array){
+            if(bit->type <= Unsafe){
+                write_var_bit(bit, sink, in_array);
+            } else if(bit->type == Array){
+                write_array_bit(bit, sink);
+            } else {
+                write_container_bit(bit, sink);
+            }
+        }
+        
+        void db::write_all_bits(db_bits * bits, lan::db_sink & sink){
+            for(db_bit * buffer = bits ; buffer ; buffer = buffer->nex)
+                write_bit(buffer, sink);
+        }
+        
+        std::string db::write_container_bit(db_bit * bits){
+            std::string bits_str;
+            db_sink sink(bits_str);
+            write_container_bit(bits, sink);
+            return bits_str;
+        }
+        
+        std::string db::write_array_bit(db_bit * bits){
+            std::string bits_str;
+            db_sink sink(bits_str);
+            write_array_bit(bits, sink);
             return bits_str;
         }
         
@@ -382,58 +1737,381 @@ namespace lan
         }
         
         std::string db::prepare_string_to_write(std::string src){
-            std::string dst, temp ;
-            for(auto ch  : src){
-                if(ch == '\"' or ch == '\\') dst += "\\";
-                dst += ch;
-            } return dst;
+            std::string dst;
+            db_sink sink(dst);
+            prepare_string_to_write(std::string_view(src), sink);
+            return dst;
         }
         
         std::string db::write_var_bit(db_bit * bit, bool in_array){
-            if(!bit->data) return "";
-            std::string bit_str = bit->key + ((!in_array) ? '=' : ' ') + db_bit_table [bit->type] + ':';
-            switch (bit->type) {
-                case Bool:      bit_str += std::to_string(get<bool>(bit));      break;
-                case Int:       bit_str += std::to_string(get<int>(bit));       break;
-                case Long:      bit_str += std::to_string(get<long>(bit));      break;
-                case LongLong:  bit_str += std::to_string(get<long long>(bit)); break;
-                case Float:     bit_str += std::to_string(get<float>(bit));     break;
-                case Double:    bit_str += std::to_string(get<double>(bit));    break;
-                case Char:      bit_str += '"' + prepare_char_to_write(get<char>(bit)) + '"'; break;
-                case String:    bit_str += '"' + prepare_string_to_write(get<std::string>(bit)) + '"';    break;
-                default:        bit_str = ""; break;
-            } return bit_str + (' ');
+            std::string bit_str;
+            db_sink sink(bit_str);
+            write_var_bit(bit, sink, in_array);
+            return bit_str;
         }
         
         std::string db::write_bit(db_bit * bit, bool in_array){
             std::string bit_str;
-            if(bit->type <= Unsafe){
-                bit_str = write_var_bit(bit, in_array);
-            } else if(bit->type == Array){
-                bit_str = write_array_bit(bit);
-            } else {
-                bit_str = write_container_bit(bit);
-            } return bit_str;
+            db_sink sink(bit_str);
+            write_bit(bit, sink, in_array);
+            return bit_str;
         }
         
         std::string db::write_all_bits(db_bits * bits){
-            db_bit * buffer = bits;
             std::string bits_str = "";
-            while(buffer){
-                bits_str += write_bit(buffer);
-                buffer = buffer->nex;
-            }
+            db_sink sink(bits_str);
+            write_all_bits(bits, sink);
             return bits_str;
         }
         
+        void db::write_varint(uint64_t value, lan::db_sink & sink){
+            while(value >= 0x80){
+                sink.put((char)(value | 0x80));
+                value >>= 7;
+            } sink.put((char)value);
+        }
+        
+        /* Floats and doubles are written as the little-endian bytes of their IEEE 754 bits, read through a same-size integer
+         * (so hosts of either byte order agree, as long as they store floats and integers in the same order). */
+        static_assert(std::numeric_limits<float>::is_iec559 and std::numeric_limits<double>::is_iec559, "LANDB: the binary format needs IEEE 754 floats");
+        
+        void db::write_binary_bit(db_bit * bit, lan::db_sink & sink){
+            char fixed [8];
+            uint64_t value = 0;
+            uint32_t raw_f = 0;
+            if(bit->type == Unsafe or (bit->type < Array and not bit->data)) return;
+            sink.put((char)bit->type);
+            write_varint(bit->key.length(), sink);
+            sink.write(bit->key);
+            switch(bit->type){
+                case Bool:      sink.put((char)get<bool>(bit)); break;
+                case Int:       write_varint(((uint64_t)(int64_t)get<int>(bit) << 1) ^ (uint64_t)((int64_t)get<int>(bit) >> 63), sink); break;
+                case Long:      write_varint(((uint64_t)(int64_t)get<long>(bit) << 1) ^ (uint64_t)((int64_t)get<long>(bit) >> 63), sink); break;
+                case LongLong:  write_varint(((uint64_t)(int64_t)get<long long>(bit) << 1) ^ (uint64_t)((int64_t)get<long long>(bit) >> 63), sink); break;
+                case Float:     memcpy(&raw_f, bit->data, 4); for(size_t i = 0 ; i < 4 ; i++) fixed[i] = (char)(raw_f >> (8*i)); sink.write(std::string_view(fixed, 4)); break;
+                case Double:    memcpy(&value, bit->data, 8); for(size_t i = 0 ; i < 8 ; i++) fixed[i] = (char)(value >> (8*i)); sink.write(std::string_view(fixed, 8)); break;
+                case Char:      sink.put(get<char>(bit)); break;
+                case String:    write_varint(get<std::string>(bit).length(), sink); sink.write(get<std::string>(bit)); break;
+                default:
+                    for(db_bit * buffer = expand(bit) ; buffer ; buffer = buffer->nex)
+                        write_binary_bit(buffer, sink);
+                    sink.put((char)db_binary_end);
+                    break;
+            }
+        }
+        
+        void db::write_all_binary_bits(db_bits * bits, lan::db_sink & sink){
+            sink.write(db_binary_magic);
+            for(db_bit * buffer = bits ; buffer ; buffer = buffer->nex)
+                write_binary_bit(buffer, sink);
+        }
+        
+        void db::write_range(lan::db_push_task const & task, lan::db_format format, lan::db_sink & sink){
+            for(db_bit * buffer = task.begin ; buffer != task.end ; buffer = buffer->nex){
+                if(format == Binary) write_binary_bit(buffer, sink);
+                else {
+                    write_bit(buffer, sink, task.in_array);
+                    if(task.in_array and buffer->nex) sink.put(' ');
+                }
+            }
+        }
+        
+        size_t db::count_bits(lan::db_bit const * bit, lan::db_bit_sizes & sizes){
+            size_t count = 1;
+            if(not bit->lin) return count;
+            for(lan::db_bit const * buffer = bit->lin ; buffer ; buffer = buffer->nex)
+                count += count_bits(buffer, sizes);
+            return (sizes[bit] = count);
+        }
+        
+        void db::plan_bits(lan::db_bits * bits, bool in_array, size_t size, lan::db_format format, lan::db_bit_sizes const & sizes, std::vector<lan::db_push_task> & plan){
+            lan::db_bit * start = bits;
+            size_t weight = 0, count;
+            std::string text;
+            db_sink sink(text);
+            for( ; bits ; bits = bits->nex){
+                count = (bits->lin) ? sizes.at(bits) : 1;
+                if(count > size and bits->type >= Array and bits->lin){
+                    if(start != bits) plan.push_back({"", start, bits, in_array});
+                    text.clear();
+                    if(format == Binary){
+                        sink.put((char)bits->type);
+                        write_varint(bits->key.length(), sink);
+                        sink.write(bits->key);
+                    } else if(bits->type == Array){
+                        if(bits->key.length()) sink.write(bits->key).put('=');
+                        sink.write("a:[");
+                    } else sink.put('(').write(bits->key).write(": ");
+                    plan.push_back({text, nullptr, nullptr, false});
+                    plan_bits(bits->lin, bits->type == Array, size, format, sizes, plan);
+                    text.clear();
+                    if(format == Binary) sink.put((char)db_binary_end);
+                    else sink.put((bits->type == Array) ? ']' : ')');
+                    if(format == Text and in_array and bits->nex) sink.put(' ');
+                    plan.push_back({text, nullptr, nullptr, false});
+                    start = bits->nex;
+                    weight = 0;
+                } else if((weight += count) >= size){
+                    plan.push_back({"", start, bits->nex, in_array});
+                    start = bits->nex;
+                    weight = 0;
+                }
+            } if(start) plan.push_back({"", start, nullptr, in_array});
+        }
+        
+        void db::write_all(lan::db_sink & sink, lan::db_format format, size_t threads){
+            std::vector<lan::db_push_task> plan;
+            std::vector<std::exception_ptr> failures (threads);
+            std::vector<std::thread> pool;
+            std::atomic<size_t> next (0);
+            lan::db_bit_sizes sizes;
+            size_t total = 0;
+            for(db_bit * buffer = first ; buffer ; buffer = buffer->nex)
+                total += count_bits(buffer, sizes);
+            if(format == Binary) sink.write(db_binary_magic);
+            if(total < 2 * db_parallel_bits){
+                write_range({"", first, nullptr, false}, format, sink);
+                return;
+            } plan_bits(first, false, std::max(db_parallel_bits, total / (threads * 4)), format, sizes, plan);
+            for(size_t t = 0 ; t < std::min(threads, plan.size()) ; t++){
+                pool.emplace_back([&, t](){
+                    try {
+                        for(size_t task ; (task = next++) < plan.size() ; ){
+                            if(not plan[task].begin) continue;
+                            db_sink target(plan[task].text);
+                            write_range(plan[task], format, target);
+                        }
+                    } catch (...) {
+                        failures[t] = std::current_exception();
+                        next = plan.size();
+                    }
+                });
+            } for(std::thread & worker : pool)
+                worker.join();
+            for(std::exception_ptr & error : failures)
+                if(error) std::rethrow_exception(error);
+            for(lan::db_push_task & task : plan)
+                sink.write(task.text);
+        }
+        
         bool db::push(){
-            std::string data_str = write_all_bits(first);
-            return file.push(data_str);
+            LANDB_COUNT(pushes, 1);
+            LANDB_TIME(write_ns);
+            if(not journaling){
+                std::lock_guard<std::mutex> guard(pushes->mutex);
+                return file.push([&](lan::db_sink & sink){
+                    std::shared_lock<std::shared_mutex> lock = read_lock();
+                    pushes->generation = generation;
+                    write_all(sink, format);
+                });
+            }
+            {
+                std::unique_lock<std::shared_mutex> lock = exclusive_lock();
+                if(not journal_file.append(journal)) return false;
+                journal.clear();
+                if(journal_file.length() <= std::max(db_journal_compact_size, file.length()))
+                    return true;
+            } return compact();
+        }
+        
+        bool db::push(lan::db_sink & sink){
+            return push(sink, Text);
+        }
+        
+        bool db::push(lan::db_sink & sink, lan::db_format format){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            return write_all(sink, format);
+        }
+        
+        std::future<bool> db::push_async(){
+            std::shared_ptr<lan::db> view;
+            std::shared_ptr<lan::db_push_state> state = pushes;
+            std::promise<bool> done;
+            std::string filename;
+            lan::db_format format;
+            if(journaling){
+                done.set_value(push());
+                return done.get_future();
+            } view = snapshot();
+            {
+                std::shared_lock<std::shared_mutex> lock = read_lock();
+                filename = file.name();
+                format = this->format;
+            } return std::async(std::launch::async, [view, state, filename, format](){
+                lan::safe_file target;
+                std::lock_guard<std::mutex> guard(state->mutex);
+                if(view->generation < state->generation) return true;
+                state->generation = view->generation;
+                return target.open(filename) and target.push([&](lan::db_sink & sink){ view->write_all(sink, format); });
+            });
+        }
+        
+        bool db::write_all(lan::db_sink & sink, lan::db_format format){
+            LANDB_TIME(serialize_ns);
+            if(threads > 1 and pending.empty())
+                write_all(sink, format, threads);
+            else if(format == Binary) write_all_binary_bits(first, sink);
+            else write_all_bits(first, sink);
+            return sink.good();
+        }
+        
+        /* journal */
+        
+        void db::set_journal(bool enabled){
+            std::unique_lock<std::shared_mutex> lock = exclusive_lock();
+            journal.clear();
+            if((journaling = enabled) and file.name().length()) journal_file.assign(file.name() + ".journal");
+            else if(not enabled) journal_file.close();
+        }
+        
+        bool db::compact(){
+            std::unique_lock<std::shared_mutex> lock = exclusive_lock();
+            bool done = file.push([&](lan::db_sink & sink){ write_all(sink, format); });
+            if(done and journaling){
+                journal.clear();
+                done = journal_file.push(std::string());
+            } return done;
+        }
+        
+        bool db::log_record(lan::db_journal_op op, lan::db_bit * target, lan::db_bit * bit, size_t index){
+            std::string record;
+            db_sink sink(record), header(journal);
+            if(bit and bit->type == Unsafe) return true;
+            sink.put((char)op);
+            write_path(target, sink);
+            if(op == journal_set_index) write_varint(index, sink);
+            if(bit) write_binary_bit(bit, sink);
+            write_varint(record.length(), header);
+            header.write(record);
+            return true;
+        }
+        
+        void db::write_path(lan::db_bit * bit, lan::db_sink & sink){
+            std::vector<lan::db_bit *> path;
+            for( ; bit ; bit = bit->con) path.push_back(bit);
+            write_varint(path.size(), sink);
+            for(std::vector<lan::db_bit *>::reverse_iterator step = path.rbegin() ; step != path.rend() ; step++){
+                if((*step)->con and (*step)->con->type == Array){
+                    if(*step != journal_element or journal_structure != structure){
+                        lan::db_array * items = get_array_items((*step)->con);
+                        journal_index = std::find(items->begin(), items->end(), *step) - items->begin();
+                        journal_element = *step;
+                        journal_structure = structure;
+                    } sink.put(1);
+                    write_varint(journal_index, sink);
+                } else {
+                    // a bit shadowed by others of the same key and type is written with the number of those before it
+                    lan::db_bit * match = find_any((*step)->key, (*step)->type, ((*step)->con) ? (*step)->con->lin : first);
+                    size_t rank = 0;
+                    for( ; match and match != *step ; match = match->nex)
+                        if(match->type == (*step)->type and match->key == (*step)->key) rank++;
+                    sink.put((rank) ? 2 : 0).put((char)(*step)->type);
+                    write_varint((*step)->key.length(), sink);
+                    sink.write((*step)->key);
+                    if(rank) write_varint(rank, sink);
+                }
+            }
+        }
+        
+        bool db::read_path(std::string_view content, size_t & offset, lan::db_bit *& target){
+            uint64_t steps = read_varint(content, offset);
+            lan::db_bit * context = nullptr;
+            for(uint64_t i = 0 ; i < steps ; i++){
+                uint64_t tag = read_fixed(content, offset, 1), rank;
+                if(tag == 1){
+                    if(not context or not (context = get_array_bit(context, read_varint(content, offset))))
+                        return false;
+                } else {
+                    db_bit_type type = (db_bit_type)read_fixed(content, offset, 1);
+                    std::string name (read_binary_string(content, offset));
+                    if(not (context = find_any(name, type, (context) ? expand(context) : first)))
+                        return false;
+                    for(rank = (tag == 2) ? read_varint(content, offset) : 0 ; rank ; rank--){
+                        for(context = context->nex ; context and (context->type != type or context->key != name) ; context = context->nex);
+                        if(not context) return false;
+                    }
+                }
+            } target = context;
+            return true;
+        }
+        
+        size_t db::replay(std::string_view content){
+            size_t offset = 0, records = 0, length;
+            while(offset < content.length()){
+                try {
+                    length = read_varint(content, offset);
+                } catch (lan::errors::pull_error &) {
+                    break;
+                } if(length > content.length() - offset) break;
+                replay_record(content.substr(offset, length));
+                offset += length;
+                records++;
+            } return records;
+        }
+        
+        void db::replay_record(std::string_view content){
+            size_t offset = 1;
+            lan::db_bit * target = nullptr, * bit = nullptr, * buffer;
+            uint64_t position = 0;
+            db_journal_op op = (db_journal_op)content[0];
+            if(op == journal_erase){
+                release_bits();
+                return;
+            } if(not read_path(content, offset, target))
+                throw lan::errors::pull_error ("LANDB (pull_error): unable to replay the journal, a bit was not found.");
+            if(op == journal_remove){
+                if(target) erase_bit(target);
+                return;
+            } if(op == journal_set_index) position = read_varint(content, offset);
+            if(not (bit = parse_binary_bit(content, offset)))
+                throw lan::errors::pull_error ("LANDB (pull_error): unable to replay the journal, invalid record.");
+            switch(op){
+                case journal_set:
+                    if((buffer = find_any(bit->key, bit->type, (target) ? expand(target) : first))){
+                        copy_data(buffer, bit);
+                        arena.release_bit(bit);
+                    } else link_bit(target, bit);
+                    break;
+                case journal_set_index:
+                    if(target and (buffer = get_array_bit(target, position))){
+                        clear_bit(buffer);
+                        unindex_bit(buffer);
+                        buffer->type = bit->type;
+                        index_bit(buffer);
+                        copy_data(buffer, bit);
+                    } erase_bits(bit);
+                    break;
+                default:
+                    link_bit(target, bit);
+                    break;
+            }
+        }
+        
+        bool db::link_bit(lan::db_bit * context, lan::db_bit * bit){
+            bit->con = context;
+            attach(context, bit);
+            return index_bit(bit);
+        }
+        
+        void db::copy_data(lan::db_bit * target, lan::db_bit * source){
+            drop_data(target);
+            switch(source->type){
+                case Bool:      set_data<bool>(target, get<bool>(source)); break;
+                case Int:       set_data<int>(target, get<int>(source)); break;
+                case Long:      set_data<long>(target, get<long>(source)); break;
+                case LongLong:  set_data<long long>(target, get<long long>(source)); break;
+                case Float:     set_data<float>(target, get<float>(source)); break;
+                case Double:    set_data<double>(target, get<double>(source)); break;
+                case Char:      set_data<char>(target, get<char>(source)); break;
+                case String:    set_data<std::string>(target, get<std::string>(source)); break;
+                default:        break;
+            }
         }
         
         /* ... */
         
-        std::string db::error_string(errors::_private::error_type type, std::string const name){
+        std::string db::error_string(errors::_private::error_type type, std::string const name) const {
+            LANDB_COUNT(exceptions, 1);
             switch (type) {
                 case errors::_private::_bit_name_error:
                     return ("LANDB (bit_name_error): Unable to find bit \""+name+"\"."); break;
@@ -449,11 +2127,10 @@ namespace lan
         
         /* find */
         
-        std::string db::find__pop_address(std::string & address){
-            size_t length = address.find('.');
-            length = (length < address.length()) ? length : address.length();
-            std::string string = address.substr(0,length);
-            address.erase(0, length+1);
+        std::string_view db::find__pop_address(std::string_view & address){
+            size_t length = std::min(address.find('.'), address.length());
+            std::string_view string = address.substr(0, length);
+            address.remove_prefix(std::min(length + 1, address.length()));
             return string;
         }
         
@@ -467,24 +2144,24 @@ namespace lan
             } return nullptr;
         }
         
-        lan::db_bits * db::find_rec(std::string address, lan::db_bit_type const type, lan::db_bit * ref){
-            std::string string = find__pop_address(address);
+        lan::db_bits * db::find_rec(std::string_view address, lan::db_bit_type const type, lan::db_bit * ref){
+            std::string_view string = find__pop_address(address);
             if(address.empty()) {
                 return find_any(string, type, ref);
             } else if(not string.empty()) {
                 if((ref = find_any(string, type, ref))){
-                    return find_rec(address, type, ref->lin);
+                    return find_rec(address, type, expand(ref));
                 }
             } return nullptr;
         }
         
-        lan::db_bits * db::find_rec(std::string address, lan::db_bit_type const type, lan::db_bit_type const final_type, lan::db_bit * ref){
-            std::string string = find__pop_address(address);
+        lan::db_bits * db::find_rec(std::string_view address, lan::db_bit_type const type, lan::db_bit_type const final_type, lan::db_bit * ref){
+            std::string_view string = find__pop_address(address);
             if(address.empty()) {
                 return find_any(string, final_type, ref);
             } else if(not string.empty()) {
                 if((ref = find_any(string, type, ref))){
-                    return find_rec(address, type, final_type, ref->lin);
+                    return find_rec(address, type, final_type, expand(ref));
                 }
             } return nullptr;
         }
@@ -500,21 +2177,216 @@ namespace lan
             } return nullptr;
         }
         
-        lan::db_bit * db::find_any(const std::string name, const lan::db_bit_type type, lan::db_bit * ref){
-            lan::db_bit * buf = nullptr;
+        lan::db_bit * db::find_any(std::string_view const name, const lan::db_bit_type type, lan::db_bit * ref){
+            lan::db_bit * buf = ref, * context = (ref) ? ref->con : nullptr;
+            lan::db_index * index = nullptr;
+            size_t visited = 0;
             if(name == "@" && anchor) return anchor;
             else if(name == "@") throw lan::errors::anchor_name_error(error_string(errors::_private::_empty_anchor_error, ""));
-            while ((buf = find(name, ref))) {
-                if(buf->type == type) return buf;
-                ref = buf->nex;
-            } return nullptr;
+            LANDB_COUNT(lookups, 1);
+            if(ref and not ref->pre and (index = get_context_index(context))){
+                lan::db_index::iterator entry = index->find({name, type});
+                LANDB_COUNT(visited, 1);
+                return (entry != index->end()) ? entry->second.bit : nullptr;
+            } while (buf) {
+                if(buf->type == type and buf->key == name) break;
+                buf = buf->nex; visited++;
+            } LANDB_COUNT(visited, visited + (buf != nullptr));
+            if(visited >= db_index_threshold and indexing and ref and not ref->pre and ((context) ? context->type == lan::Container : ref == first))
+                build_context_index(context);
+            return buf;
+        }
+        
+        /* lookup */
+        
+        const lan::db_bit * db::lookup(std::string_view name, lan::db_bit_type const type, const lan::db_bit * ref) const {
+            const lan::db_index * index;
+            size_t visited = 0;
+            if(frozen and type == Unsafe) return nullptr;
+            if(name == "@" && anchor) return anchor;
+            else if(name == "@") throw lan::errors::anchor_name_error(error_string(errors::_private::_empty_anchor_error, ""));
+            LANDB_COUNT(lookups, 1);
+            if(ref and not ref->pre and (index = (ref->con) ? ref->con->index : this->index)){
+                lan::db_index::const_iterator entry = index->find({name, type});
+                LANDB_COUNT(visited, 1);
+                return (entry != index->end()) ? entry->second.bit : nullptr;
+            } for( ; ref ; ref = ref->nex, visited++)
+                if(ref->type == type and ref->key == name) break;
+            LANDB_COUNT(visited, visited + (ref != nullptr));
+            return ref;
+        }
+        
+        const lan::db_bit * db::lookup(std::string_view address, lan::db_bit_type const type, lan::db_bit_type const final_type, const lan::db_bit * ref) const {
+            size_t length;
+            while((length = address.find('.')) != std::string_view::npos){
+                if(length == 0 or not (ref = lookup(address.substr(0, length), type, ref)) or ref->pending)
+                    return nullptr;
+                ref = ref->lin;
+                address.remove_prefix(length + 1);
+            } return lookup(address, final_type, ref);
+        }
+        
+        const lan::db_bit * db::lookup(const lan::db_bits * array, size_t index) const {
+            if(not array or array->type != lan::Array or array->pending) return nullptr;
+            if(array->items) array = (index < array->items->size()) ? (*array->items)[index] : nullptr;
+            else for(array = array->lin ; array and index ; array = array->nex, index--);
+            return (array and frozen and array->type == Unsafe) ? nullptr : array;
+        }
+        
+        const lan::db_bit * db::search(std::string_view const name, lan::db_bit_type const type){
+            return (read_only()) ? lookup(name, type, first) : find_any(name, type, first);
+        }
+        
+        const lan::db_bit * db::search(std::string_view const context, std::string_view const name, lan::db_bit_type const type){
+            const lan::db_bit * bit;
+            lan::db_bit * buffer;
+            if(read_only())
+                return ((bit = lookup(context, lan::Container, lan::Container, first)) and not bit->pending) ? lookup(name, type, bit->lin) : nullptr;
+            return (buffer = find_rec(context, lan::Container, first)) ? find_any(name, type, expand(buffer)) : nullptr;
+        }
+        
+        const lan::db_bit * db::search(std::string_view const name, size_t index){
+            lan::db_bit * buffer;
+            if(read_only()) return lookup(lookup(name, lan::Array, first), index);
+            return (buffer = find_any(name, lan::Array, first)) ? get_array_bit(buffer, index) : nullptr;
+        }
+        
+        lan::db_bit * db::place(lan::db_bit * context, std::string name, db_bit_type const type){
+            lan::db_bit * bit;
+            if(not (bit = find_any(name, type, (context) ? expand(context) : first)))
+                attach(context, bit = arena.make_bit());
+            set_bit(context, bit, std::move(name), type);
+            return bit;
+        }
+        
+        /* items */
+        
+        lan::db_bit * db::search_list(std::string_view const name){
+            const lan::db_bit * bit;
+            lan::db_bit * buffer;
+            if(name.empty()) return nullptr;
+            if(read_only()){
+                if(((bit = lookup(name, lan::Container, lan::Array, first)) or (bit = lookup(name, lan::Container, lan::Container, first))) and not bit->pending)
+                    return (lan::db_bit *)bit;
+            } else if((buffer = find_rec(name, lan::Container, lan::Array, first)) or (buffer = find_rec(name, lan::Container, first))){
+                expand(buffer);
+                return buffer;
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(name)+"{Array|Container}"));
+        }
+        
+        lan::db_bit * db::items_head(std::string_view const name){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            lan::db_bit * context = search_list(name);
+            return (context) ? context->lin : first;
+        }
+        
+        size_t db::size(std::string_view const name){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            lan::db_bit * context = search_list(name);
+            if(read_only()) return count_of(context);
+            get_tail(context);
+            return (context) ? context->count : length;
+        }
+        
+        lan::db_range<> db::items(std::string_view const name){
+            return lan::db_range<>(items_head(name));
+        }
+        
+        lan::db_range<> db::items(std::string_view const name, lan::db_bit_type const type){
+            return lan::db_range<>(items_head(name), true, type);
+        }
+        
+        /* path */
+        
+        lan::db_bit * db::resolve(lan::path const & target, lan::db_bit_type const type, size_t steps){
+            lan::db_bit * bit = nullptr;
+            steps = std::min(steps, target.size());
+            for(size_t i = 0 ; i < steps ; i++){
+                lan::db_bit_type step = (i + 1 < target.size()) ? lan::Container : type;
+                if(read_only()) bit = (lan::db_bit *)lookup(target[i], step, (bit) ? bit->lin : first);
+                else bit = find_any(target[i], step, (bit) ? expand(bit) : first);
+                if(not bit) return nullptr;
+            } return bit;
+        }
+        
+        lan::db_bit * db::resolve(lan::handle & target){
+            lan::db_bit * bit;
+            // readers may share a handle under the shared lock, they can only store the same bit for the same structure
+            if(target.structure.load(std::memory_order_acquire) == structure and (bit = target.bit.load(std::memory_order_relaxed)) and bit->type == target.type)
+                return bit;
+            bit = resolve(target.path, target.type);
+            target.bit.store(bit, std::memory_order_relaxed);
+            target.structure.store(structure, std::memory_order_release);
+            return bit;
+        }
+        
+        bool db::check_batch(std::string_view const context, lan::db::fields const & found){
+            std::string names;
+            if(found.failures().empty()) return true;
+            for(std::string const & name : found.failures())
+                names += ((names.empty()) ? "" : ", ") + std::string(context) + "." + name;
+            throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, names));
+        }
+        
+        /* index */
+        
+        lan::db_index * db::get_context_index(lan::db_bit * context){
+            if(context and context->type != lan::Container) return nullptr;
+            return (context) ? context->index : index;
+        }
+        
+        lan::db_index * db::build_context_index(lan::db_bit * context){
+            lan::db_bit * buffer = (context) ? expand(context) : first;
+            lan::db_index * target = nullptr;
+            if(context and context->type != lan::Container) return nullptr;
+            target = new db_index;
+            if(context) {if(context->index) delete context->index; context->index = target;}
+            else {if(index) delete index; index = target;}
+            for( ; buffer ; buffer = buffer->nex){
+                std::pair<db_index::iterator, bool> entry = target->insert({{buffer->key, buffer->type}, {buffer, 0}});
+                if(not entry.second) entry.first->second.shadowed++;
+            } return target;
+        }
+        
+        void db::drop_indexes(lan::db_bits * bits){
+            for( ; bits ; bits = bits->nex){
+                if(bits->index) {delete bits->index; bits->index = nullptr;}
+                if(bits->lin) drop_indexes(bits->lin);
+            }
+        }
+        
+        bool db::index_bit(lan::db_bit * bit){
+            lan::db_index * target = get_context_index(bit->con);
+            if(target){
+                std::pair<db_index::iterator, bool> entry = target->insert({{bit->key, bit->type}, {bit, 0}});
+                if(not entry.second and entry.first->second.bit != bit) entry.first->second.shadowed++;
+            } return (bit);
+        }
+        
+        void db::unindex_bit(lan::db_bit * bit){
+            lan::db_index * target = get_context_index(bit->con);
+            lan::db_index::iterator entry;
+            lan::db_bit * buffer;
+            if(not target or (entry = target->find({bit->key, bit->type})) == target->end())
+                return;
+            if(entry->second.bit != bit){
+                if(entry->second.shadowed) entry->second.shadowed--;
+            } else if(not entry->second.shadowed){
+                target->erase(entry);
+            } else {
+                size_t shadowed = entry->second.shadowed - 1;
+                for(buffer = bit->nex ; buffer and (buffer->type != bit->type or buffer->key != bit->key) ; buffer = buffer->nex);
+                target->erase(entry);
+                if(buffer) target->insert({{buffer->key, buffer->type}, {buffer, shadowed}});
+            }
         }
         
         /* db general */
         
         bool db::declare(std::string const name, db_bit_type const type){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
             if(!(data = find_any(name, type, first)))
-                return (last) ? append(name, 0, type) : init(name, 0, type);
+                return insert(nullptr, name, 0, type) and log(journal_declare, nullptr, last);
             else {
                 std::string str = data->key;
                 str += ("{");
@@ -525,21 +2397,66 @@ namespace lan
             } return false;
         }
         
-        bool db::declare(std::string const target, std::string const name, db_bit_type const type){
-            return ((data = find_rec(target, lan::Container, first)))
-            ? (data->lin) ? append(data, name, 0, type) : init(data, name, 0, type): throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, target+("{Container}")));
+        bool db::declare(std::string_view const target, std::string const name, db_bit_type const type){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            lan::db_bit * context;
+            if(not (context = data = find_rec(target, lan::Container, first)))
+                throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(target)+("{Container}")));
+            expand(context);
+            return insert(context, name, 0, type) and log(journal_declare, context, data);
         }
         
         /* get */
         
+        lan::db_array * db::get_array_items(lan::db_bits * array){
+            if(not array->items){
+                array->items = new db_array;
+                for(lan::db_bit * buffer = expand(array) ; buffer ; buffer = buffer->nex)
+                    array->items->push_back(buffer);
+            } return array->items;
+        }
+        
         lan::db_bit * db::get_array_bit(lan::db_bits * array, size_t index){
-            lan::db_bit * buffer = array;
-            if(array->type == lan::Array and (buffer = buffer->lin)){
-                for(register_t i = 0 ; i < index ; i++, buffer = buffer->nex){
-                    if(!buffer)
-                        return nullptr;
-                }
-            } return buffer;
+            lan::db_array * items;
+            if(array->type == lan::Array and index < (items = get_array_items(array))->size())
+                return (*items)[index];
+            return nullptr;
+        }
+        
+        lan::db_bit * db::get_tail(lan::db_bit * context){
+            lan::db_bit *& tail = (context) ? context->tail : last;
+            size_t & count = (context) ? context->count : length;
+            if(tail and not tail->nex) return tail;
+            tail = nullptr;
+            count = 0;
+            for(lan::db_bit * buffer = (context) ? expand(context) : first ; buffer ; buffer = buffer->nex, count++)
+                tail = buffer;
+            return tail;
+        }
+        
+        size_t db::count_of(const lan::db_bit * context) const {
+            const lan::db_bit * tail = (context) ? context->tail : last;
+            size_t count = 0;
+            if(tail and not tail->nex) return (context) ? context->count : length;
+            for(tail = (context) ? context->lin : first ; tail ; tail = tail->nex)
+                count++;
+            return count;
+        }
+        
+        void db::attach(lan::db_bit * context, lan::db_bit * bit){
+            lan::db_bit * tail = get_tail(context);
+            bit->nex = nullptr;
+            if((bit->pre = tail)) tail->nex = bit;
+            else if(context) context->lin = bit;
+            else first = bit;
+            if(context){
+                context->tail = bit;
+                context->count++;
+                if(context->items) context->items->push_back(bit);
+            } else {
+                last = bit;
+                length++;
+            }
         }
         
         lan::db_bit * db::get_last_bit(lan::db_bits * bits){
@@ -549,8 +2466,10 @@ namespace lan
         }
         
         lan::db_bit_type db::get_var_type(const std::string name){
-            if((data = find_var(name, first)))
-                return data->type;
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            lan::db_bit * bit;
+            if((bit = find_var(name, first)))
+                return bit->type;
             else
                 throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, name));
         }
@@ -564,31 +2483,61 @@ namespace lan
         /* remove */
         
         bool db::remove(const std::string name, const db_bit_type type){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
             if ((data = find_rec(name, type, first))) {
+                log(journal_remove, data);
                 erase_bit(data);
                 return true;
             } return false;
         }
         
-        bool db::remove(const std::string context, const std::string name, const db_bit_type type){
+        bool db::remove(std::string_view const context, const std::string name, const db_bit_type type){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
             if ((data = find_rec(context, lan::Container, first))) {
-                if ((data = find_rec(name, type, data->lin))) {
+                if ((data = find_rec(name, type, expand(data)))) {
+                    log(journal_remove, data);
                     erase_bit(data);
                     return true;
                 }
             } return false;
         }
         
-        bool db::remove(const std::string array, size_t index){
+        bool db::remove(lan::path const & target, const db_bit_type type){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            if ((data = resolve(target, type))) {
+                log(journal_remove, data);
+                erase_bit(data);
+                return true;
+            } return false;
+        }
+        
+        bool db::remove(lan::handle & target){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            if ((data = resolve(target))) {
+                log(journal_remove, data);
+                erase_bit(data);
+                target.bit = nullptr;
+                return true;
+            } return false;
+        }
+        
+        bool db::remove(std::string_view const array, size_t index){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
             if ((data = find_rec(array, lan::Container, lan::Array, first)) and
                 (data = get_array_bit(data, index))) {
+                log(journal_remove, data);
                 erase_bit(data);
                 return true;
                 } return false;
         }
         
         db::~db(){
-            if(last)
-                erase();
+            if(frozen and not retained){
+                // a view of bits that the database it was taken from still owns
+                first = nullptr;
+                index = nullptr;
+                return;
+            } if(shared) unshare(false);
+            release_bits();
         }
 } 
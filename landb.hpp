@@ -11,15 +11,77 @@
 
 #pragma once
 
+#include <atomic>
+#include <cassert>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 namespace lan
 {
+    /* lan::db_sink */
+    
+    //! @brief size of the buffer of a db_sink.
+    const size_t db_sink_size = 64 * 1024;
+    
+    /// @brief Buffered output used to stream a landb-structure, writes to a file descriptor or appends to a user buffer.
+    class db_sink {
+        int fd;
+        std::string * target;
+        std::string buffer;
+        bool failed;
+        
+    public:
+        
+        /* streams to a file descriptor (not closed by the sink) */
+        db_sink(int);
+        /* streams to the end of a user buffer */
+        db_sink(std::string &);
+        db_sink(db_sink const &) = delete;
+        db_sink & operator = (db_sink const &) = delete;
+        
+        /* writes a sequence of chars */
+        db_sink & write(std::string_view data){
+            if(target) target->append(data);
+            else if(buffer.length() + data.length() <= db_sink_size) buffer.append(data);
+            else if(flush() and data.length() < db_sink_size) buffer.append(data);
+            else write_fd(data);
+            return *this;
+        }
+        /* writes a char */
+        db_sink & put(char data){
+            if(target) target->push_back(data);
+            else {if(buffer.length() >= db_sink_size) flush(); buffer.push_back(data);}
+            return *this;
+        }
+        /* writes the buffered data to the file descriptor */
+        bool flush();
+        /* writes directly to the file descriptor */
+        bool write_fd(std::string_view);
+        /* no write has failed */
+        bool good() const;
+        
+        ~db_sink();
+    };
+    
     /* lan::safe_file */
     class safe_file {
         FILE * file;
         std::string filename;
+        void * map;
+        size_t map_length;
 
     public:
         
@@ -27,12 +89,24 @@ namespace lan
         
         /* opens a file */
         bool open(std::string);
+        /* names the current file, without opening or creating it */
+        bool assign(std::string);
         /* checks if the file is opened */
         bool check();
         /* pushes a string into the current file */
         bool push(std::string);
-        /* pulls a string from the current file */
+        /* pushes into the current file through a sink (written to a temporary file, then renamed over the current file) */
+        bool push(std::function<void(lan::db_sink &)>);
+        /* appends a string to the end of the current file */
+        bool append(std::string_view);
+        /* gets the name of the current file */
+        std::string name() const;
+        /* pulls a string from the current file (in a single read) */
         std::string pull();
+        /* maps the current file in memory, read-only (valid until unmap, close or the next view) */
+        std::string_view view();
+        /* unmaps the current file */
+        bool unmap();
         /* gets the length of the current file */
         size_t length();
         /* closes the current file */
@@ -43,7 +117,7 @@ namespace lan
         ~safe_file();
     };
     
-    const std::string safe_file_version = "1.0 (stable)";
+    const std::string safe_file_version = "1.1 (stable)";
     
     /* lan::db */
     
@@ -56,6 +130,7 @@ namespace lan
         typedef std::out_of_range empty_anchor_error;
         typedef std::logic_error pull_error;
         typedef std::runtime_error overriding_bit_error;
+        typedef std::logic_error frozen_error;
         
         namespace _private {
             enum error_type {_bit_name_error, _anchor_name_error, _empty_anchor_error, _overriding_bit_error};
@@ -65,6 +140,70 @@ namespace lan
     //! @brief database bit type
     enum db_bit_type {Bool , Int, Long, LongLong, Float, Double, Char, String, Unsafe, Array, Container};
     
+    //! @brief type of the bits that store a C++ type, known at compile time (Unsafe for types without a bit type).
+    template<typename any> struct db_bit_type_of { static constexpr db_bit_type value = Unsafe; };
+    template<> struct db_bit_type_of<bool> { static constexpr db_bit_type value = Bool; };
+    template<> struct db_bit_type_of<int> { static constexpr db_bit_type value = Int; };
+    template<> struct db_bit_type_of<long> { static constexpr db_bit_type value = Long; };
+    template<> struct db_bit_type_of<long long> { static constexpr db_bit_type value = LongLong; };
+    template<> struct db_bit_type_of<float> { static constexpr db_bit_type value = Float; };
+    template<> struct db_bit_type_of<double> { static constexpr db_bit_type value = Double; };
+    template<> struct db_bit_type_of<char> { static constexpr db_bit_type value = Char; };
+    template<> struct db_bit_type_of<std::string> { static constexpr db_bit_type value = String; };
+    
+    template<typename any>
+    constexpr db_bit_type db_bit_type_v = db_bit_type_of<std::remove_cv_t<any>>::value;
+    
+    //! @brief database file format: Text (landb-structure, .ldb) or Binary (.ldbb), see db::connect.
+    enum db_format {Text, Binary};
+    
+    //! @brief first bytes of a binary (.ldbb) database: magic and version.
+    const std::string_view db_binary_magic ("LDBB\1", 5);
+    
+    //! @brief tag that closes an array or container in a binary database.
+    const unsigned char db_binary_end = 0xff;
+    
+    //! @brief operation of a journal record, see db::set_journal.
+    enum db_journal_op {journal_set = 'S', journal_set_index = 'A', journal_iterate = 'I', journal_declare = 'D', journal_remove = 'R', journal_erase = 'E'};
+    
+    //! @brief size that a journal must reach (and exceed the size of the file) to be compacted by push.
+    const size_t db_journal_compact_size = 1024 * 1024;
+    
+    //! @brief smallest block of a landb-structure handed to a thread by a parallel pull (see db::set_threads).
+    const size_t db_parallel_block_size = 64 * 1024;
+    
+    //! @brief smallest number of bits handed to a thread by a parallel push (see db::set_threads).
+    const size_t db_parallel_bits = 4096;
+    
+    //! @brief piece of a parallel pull: an array or container split across blocks (made before the threads start), or a block of bits parsed by a thread.
+    struct db_pull_task {
+        std::string_view    text;       // the bits of a block, empty for an array or container
+        std::string_view    key;        // key of an array or container
+        db_bit_type         type;       // Array or Container, Unsafe for a block
+        size_t              parent;     // task of the array or container of the piece (npos: main context)
+        struct db_bit *     head, * tail;   // the array or container, or the bits parsed from a block
+        size_t              count;      // number of bits parsed from a block
+    };
+    
+    //! @brief piece of a parallel push: a literal, or a range of sibling bits rendered by a thread.
+    struct db_push_task {
+        std::string     text;
+        struct db_bit * begin, * end;
+        bool            in_array;
+    };
+    
+    //! @brief number of bits of every array and container (themselves included), counted once per threaded push.
+    typedef std::unordered_map<struct db_bit const *, size_t> db_bit_sizes;
+    
+    //! @brief state shared by the pushes of a database, keeps an older snapshot from overwriting a newer one (see db::push_async).
+    struct db_push_state {
+        std::mutex  mutex;
+        size_t      generation;
+        db_push_state(){
+            generation = 0;
+        }
+    };
+    
     /*
      *     namespace _private {
      *        char db_bit_table [11] = {  'b' ,   'i' ,
@@ -77,35 +216,497 @@ namespace lan
      *
      */
     
+    struct db_bit;
+    
+    //! @brief key of a context index, bits are indexed by name and type (to keep landb type-oriented).
+    struct db_index_key {
+        std::string_view key;
+        db_bit_type      type;
+        bool operator == (db_index_key const & other) const {
+            return type == other.type and key == other.key;
+        }
+    };
+    
+    //! @brief hash of a context index key.
+    struct db_index_hash {
+        size_t operator () (db_index_key const & target) const {
+            return std::hash<std::string_view>()(target.key) ^ ((size_t)target.type * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+    
+    //! @brief context index entry: the first bit with a certain key and type, and the number of bits it shadows.
+    struct db_index_entry {
+        struct db_bit * bit;
+        size_t          shadowed;
+    };
+    
+    //! @brief per context hash index, used to find bits in constant time (see db::find_any).
+    typedef std::unordered_map<db_index_key, db_index_entry, db_index_hash> db_index;
+    
+    //! @brief contiguous element store of an array, used to access array bits by index in constant time.
+    typedef std::vector<struct db_bit *> db_array;
+    
+    //! @brief number of bits that a context must have to be indexed.
+    const size_t db_index_threshold = 16;
+    
+    //! @brief inline storage of the scalar bits (Bool ... Char).
+    union db_bit_value {
+        bool            b;
+        int             i;
+        long            l;
+        long long       x;
+        float           f;
+        double          d;
+        char            c;
+    };
+    
     //! @brief database bit: used to criate linked lists that store variables, arrays and containers dynamically
     struct db_bit {
         std::string     key;
         db_bit_type     type;
-        void *          data;
+        bool            pending;    // the bits of the array or container were not parsed yet, see db::expand
+        void *          data;   // points to value for scalar bits, to an arena payload otherwise
+        db_bit_value    value;
         struct db_bit * pre, * nex, * lin, * con;
+        struct db_bit * tail;   // last bit of an array or container (nullptr until known), see db::get_tail
+        size_t          count;  // number of bits of an array or container, known with the tail
+        db_index *      index;
+        db_array *      items;
         db_bit(){
             key.clear();
+            type = Unsafe;
+            pending = false;
             data = nullptr;
+            value.x = 0;
             pre  = nullptr;
             nex  = nullptr;
             lin  = nullptr;
             con  = nullptr; 
-        } ~ db_bit (){
-            if(data or not key.empty()) { ::free(data) ; db_bit();}
-            if(lin) {delete lin; lin = nullptr;}
+            tail = nullptr;
+            count = 0;
+            index = nullptr;
+            items = nullptr;
+        }
+        /* data may point at value, so a bit stays where the arena built it. */
+        db_bit(db_bit const &) = delete;
+        db_bit & operator = (db_bit const &) = delete;
+        /* The payload is stored inside of the bit. */
+        bool inlined() const {
+            return data == (void*)&value;
+        }
+        ~ db_bit (){
+            if(index) {delete index; index = nullptr;}
+            if(items) {delete items; items = nullptr;}
         }
     };
     
     typedef db_bit db_bits;
     typedef db_bit anchor_t;
     
+    /* lan::db_iterator */
+    
+    //! @brief bidirectional iterator over the bits of an array or container (the bits themselves, or the values of one type, see db::items).
+    template<typename any = db_bit>
+    class db_iterator {
+        db_bit * bit, * head;   // head: first bit of the list, to step back from end()
+        bool filtered;
+        db_bit_type filter;
+        
+        /* Skips the bits of other types, forward or backward. */
+        void skip(bool forward){
+            while(bit and filtered and bit->type != filter)
+                bit = (forward) ? bit->nex : bit->pre;
+        }
+        
+    public:
+        
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef any value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef any * pointer;
+        typedef any & reference;
+        
+        db_iterator() : bit(nullptr), head(nullptr), filtered(false), filter(Unsafe){}
+        
+        db_iterator(db_bit * bit, db_bit * head, bool filtered, db_bit_type filter) : bit(bit), head(head), filtered(filtered), filter(filter){
+            skip(true);
+        }
+        
+        reference operator *() const {
+            if constexpr (std::is_same<any, db_bit>::value) return *bit;
+            else return *(any*)bit->data;
+        }
+        
+        pointer operator ->() const {
+            return &**this;
+        }
+        
+        /* Gets the bit (eg: its key). */
+        db_bit * get() const {
+            return bit;
+        }
+        
+        db_iterator & operator ++(){
+            bit = bit->nex;
+            skip(true);
+            return *this;
+        }
+        
+        db_iterator operator ++(int){
+            db_iterator previous (*this);
+            ++*this;
+            return previous;
+        }
+        
+        /* Stepping back from end() walks the list once to find its last bit. */
+        db_iterator & operator --(){
+            if(bit) bit = bit->pre;
+            else for(bit = head ; bit and bit->nex ; bit = bit->nex);
+            skip(false);
+            return *this;
+        }
+        
+        db_iterator operator --(int){
+            db_iterator previous (*this);
+            --*this;
+            return previous;
+        }
+        
+        bool operator ==(db_iterator const & other) const {
+            return bit == other.bit;
+        }
+        
+        bool operator !=(db_iterator const & other) const {
+            return bit != other.bit;
+        }
+    };
+    
+    //! @brief range over the bits of an array or container, for range-for and <algorithm> (see db::items).
+    template<typename any = db_bit>
+    class db_range {
+        db_bit * head;
+        bool filtered;
+        db_bit_type filter;
+        
+    public:
+        
+        typedef db_iterator<any> iterator;
+        
+        db_range(db_bit * head, bool filtered = false, db_bit_type filter = Unsafe) : head(head), filtered(filtered), filter(filter){}
+        
+        iterator begin() const {
+            return iterator(head, head, filtered, filter);
+        }
+        
+        iterator end() const {
+            return iterator(nullptr, head, filtered, filter);
+        }
+        
+        bool empty() const {
+            return begin() == end();
+        }
+        
+        /* Counts the bits, walking the list. */
+        size_t size() const {
+            return std::distance(begin(), end());
+        }
+    };
+    
+    /* lan::db_arena */
+    
+    //! @brief allocation statistics of a db_arena.
+    struct db_arena_stats {
+        size_t slabs;       // slabs reserved from the system
+        size_t reserved;    // bytes reserved from the system (slabs and large payloads)
+        size_t used;        // bytes handed out from the slabs
+        size_t recycled;    // bytes waiting in the free lists
+        size_t bits;        // live bits
+        size_t payloads;    // live payloads
+        size_t allocations; // bits and payloads allocated (counted with LANDB_STATS only, see db::stats)
+    };
+    
+    //! @brief size of a db_arena slab.
+    const size_t db_arena_slab_size = 64 * 1024;
+    
+    //! @brief number of payload size classes (16 bytes each) recycled by a db_arena.
+    const size_t db_arena_classes = 4;
+    
+    /// @brief Slab allocator that owns the bits and payloads of a lan::db, so they can be allocated in bulk and released at once.
+    class db_arena {
+        
+        struct slab {
+            slab * nex;
+            size_t size, used;
+        };
+        
+        struct payload_header {
+            void (* destroy)(void *);
+            size_t size;
+        };
+        
+        struct free_node {
+            free_node * nex;
+        };
+        
+        struct large_node {
+            large_node * pre, * nex;
+        };
+        
+        slab * slabs;
+        large_node * larges;    // payloads too large for the size classes, released with the slabs
+        free_node * free_bits;
+        free_node * free_payloads [db_arena_classes];
+        db_arena_stats counters;
+        
+    public:
+        
+        db_arena();
+        db_arena(db_arena const &) = delete;
+        db_arena & operator = (db_arena const &) = delete;
+        
+        /* Allocates 16-aligned memory from the current slab. */
+        void * allocate(size_t);
+        
+        /* Allocates an empty bit. */
+        lan::db_bit * make_bit();
+        
+        /* Destroys a bit (and its payload) and recycles its memory. */
+        void release_bit(lan::db_bit *);
+        
+        /*! @brief Allocates a payload of raw size (with a destructor, or nullptr if trivial), apart from the slabs if asked (see adopt), dependece. */
+        void * make_payload(size_t, void (*)(void *), bool apart = false);
+        
+        /*! @brief Allocates a payload built in place from arguments (a value to copy or move, or constructor arguments).
+         Eg: bit->data = arena.make<int>(1);
+         */
+        template<typename any, bool apart = false, typename... args>
+        void * make(args &&... arguments){
+            void * payload = make_payload(sizeof(any), (std::is_trivially_destructible<any>::value) ? nullptr : &db_arena::destroy<any>, apart);
+            new (payload) any (std::forward<args>(arguments)...);
+            return payload;
+        }
+        
+        /*! @brief Destroys a payload of a certain type, dependece. */
+        template<typename any>
+        static void destroy(void * payload){
+            ((any*)payload)->~any();
+        }
+        
+        /* Destroys a payload and recycles its memory. */
+        void drop(void *);
+        
+        /* Takes over a payload allocated apart by another arena, so it outlives the slabs of that arena. */
+        void * adopt(db_arena &, void *);
+        
+        /* Destroys a bit and its payload without recycling their memory, for a release() that follows. */
+        void discard_bit(lan::db_bit *);
+        
+        /* Releases every slab and large payload at once. Note: bits and payloads with destructors must be discarded first. */
+        void release();
+        
+        /* Takes over the slabs, free lists and live bits of another arena (left empty). */
+        void merge(db_arena &);
+        
+        /* Gets the allocation statistics. */
+        lan::db_arena_stats stats() const;
+        
+        /* Gets the bytes used by a payload, its header included. */
+        static size_t size_of(void *);
+        
+        ~db_arena();
+    };
+    
+    const std::string db_arena_version = "1.0 (stable)";
+    
+    /* lan::db_scanner */
+    
+    //! @brief instruction set used by db_scanner.
+    enum db_scan_level {scan_scalar, scan_sse2, scan_avx2};
+    
+    /// @brief Finds the structural chars of a landb text buffer 16 (SSE2) or 32 (AVX2) bytes at a time, the instruction set is chosen at runtime (scalar fallback).
+    class db_scanner {
+    public:
+        
+        /* Gets the index of the first blank, =:;()[] or quote at or after an offset (the length if there is none). */
+        static size_t structural(std::string_view, size_t);
+        
+        /* Gets the index of the first char that is not blank at or after an offset. */
+        static size_t non_blank(std::string_view, size_t);
+        
+        /* Gets the index of the first quote or backslash at or after an offset. */
+        static size_t quote(std::string_view, size_t);
+        
+        /* Gets the index of the first quote or bracket at or after an offset. */
+        static size_t bracket(std::string_view, size_t);
+        
+        /* Gets the instruction set in use (the best one supported by the processor by default). */
+        static db_scan_level level();
+        
+        /* Sets the instruction set in use (clamped to the ones supported by the processor), safe while other threads parse. */
+        static void set_level(db_scan_level);
+    };
+    
+    /* lan::db_cursor */
+    
+    /// @brief Single pass tokenizer over a landb text buffer, with a one token lookahead (used by db::pull).
+    class db_cursor {
+        std::string_view content;
+        std::string_view lookahead;
+        size_t offset;
+        bool peeked;
+        
+        /* Scans the next token. */
+        std::string_view scan();
+        
+    public:
+        
+        db_cursor(std::string_view);
+        
+        /* Pops the next token (empty at the end of the buffer). */
+        std::string_view next();
+        
+        /* Gets the next token without popping it. */
+        std::string_view peek();
+        
+        /* Gets the current offset in the buffer. */
+        size_t position() const;
+        
+        /* Skips to the end of the current array or container (after its opening bracket), returns the skipped block. */
+        std::string_view skip_block();
+        
+        /* Gets the index of the quote that closes the string starting at an offset. */
+        static size_t string_end(std::string_view, size_t);
+    };
+    
+    /* lan::path */
+    
+    /// @brief Dotted address of a bit ("PersonA.Address.City"), split once so it can be resolved many times (see db::resolve).
+    class path {
+        std::string address;
+        std::vector<std::pair<size_t, size_t>> steps;
+        
+    public:
+        
+        explicit path(std::string_view);
+        
+        /* Gets the number of steps. */
+        size_t size() const;
+        
+        /* Gets a step. */
+        std::string_view operator [](size_t) const;
+        
+        /* Gets the last step (the name of the bit). */
+        std::string_view back() const;
+        
+        /* Gets the address. */
+        std::string const & str() const;
+    };
+    
+    /// @brief Path resolved to a bit of a database, resolved again once bits are erased, the anchor moves or another database uses it (see db::resolve).
+    struct handle {
+        lan::path                       path;
+        lan::db_bit_type                type;
+        std::atomic<struct db_bit *>    bit;
+        std::atomic<size_t>             structure;  // structure of the database that resolved it (unique to that database), 0 if none
+        
+        handle(std::string_view address, lan::db_bit_type type) : path(address){
+            this->type = type;
+            bit = nullptr;
+            structure = 0;
+        }
+        
+        handle(handle const & other) : path(other.path){
+            *this = other;
+        }
+        
+        handle & operator =(handle const & other){
+            path = other.path;
+            type = other.type;
+            bit = other.bit.load();
+            structure = other.structure.load();
+            return *this;
+        }
+    };
+    
+    /* lan::db_memory */
+    
+    //! @brief number of bit types (see db_bit_type).
+    const size_t db_bit_types = Container + 1;
+    
+    //! @brief bytes used by the bits of a part of a lan::db (see db::memory_usage).
+    struct db_memory {
+        size_t bits;        // number of bits
+        size_t nodes;       // bytes of the bits themselves
+        size_t keys;        // bytes of the names too long to be stored in the bits
+        size_t payloads;    // bytes of the payloads of the values (inlined scalars use none)
+        size_t strings;     // bytes reserved by string values outside of their payloads
+        size_t lookups;     // bytes (estimated) of the hash indexes and item stores of arrays and containers
+        size_t pending;     // bytes of text kept for arrays and containers not parsed yet (lazy pull)
+        
+        /* Gets the sum of the bytes. */
+        size_t total() const {
+            return nodes + keys + payloads + strings + lookups + pending;
+        }
+    };
+    
+    //! @brief memory used by a subtree of a lan::db, as a whole and by type of bit.
+    struct db_memory_usage {
+        db_memory overall;
+        db_memory types [db_bit_types];
+    };
+    
+    /* lan::db_stats */
+    
+    //! @brief operation counters of a lan::db, times in nanoseconds (see db::stats).
+    template<typename counter>
+    struct db_stats_of {
+        counter pulls;          // pulls of the connected file
+        counter read_ns;        // time spent reading (or mapping) the pulled files
+        counter parse_ns;       // time spent parsing the pulled files and replaying their journals
+        counter pushes;         // pushes to the connected file
+        counter serialize_ns;   // time spent writing bits to sinks (buffered writes to the files included)
+        counter write_ns;       // time spent pushing to the connected file (serializing included)
+        counter lookups;        // bits searched by name
+        counter visited;        // bits visited by those searches (hash index hits count one)
+        counter allocations;    // bits and payloads allocated
+        counter exceptions;     // landb errors thrown by lookups, sets and pulls
+    };
+    
+    //! @brief snapshot of the operation counters of a lan::db.
+    typedef db_stats_of<uint64_t> db_stats;
+    
     /// @brief Landia Database
     class db {
         
         lan::db_bits * data;
         lan::db_bit  * first, * last;
+        size_t length;  // number of bits of the main context
         lan::anchor_t * anchor;
         lan::safe_file file;
+        lan::db_index * index;
+        bool indexing;
+        lan::db_arena arena;
+        lan::db_format format;
+        bool lazy;
+        size_t threads;
+        bool journaling;
+        std::string journal;
+        lan::safe_file journal_file;
+        lan::db_bit * journal_element;  // last array element written in a journal path, at journal_index while the structure is journal_structure
+        size_t journal_index, journal_structure;
+        std::string source;
+        std::unordered_map<lan::db_bit *, std::string_view> pending;
+        std::atomic<bool> concurrent;
+        mutable std::shared_mutex mutex;
+        bool frozen;
+        size_t generation;
+        size_t structure;  // changes when bits are erased or the anchor moves, never repeats across databases
+        std::mutex snapshot_guard;
+        std::weak_ptr<lan::db> last_snapshot;  // reused while unchanged and still held by a reader
+        bool shared;    // last_snapshot borrows the bits: readers don't build lookups, and the next change copies the bits first
+        std::unique_ptr<lan::db_arena> retained;  // snapshot: the arena of its bits, once the database that lent them changed
+        std::shared_ptr<lan::db_push_state> pushes;
+        mutable lan::db_stats_of<std::atomic<uint64_t>> counters;  // allocations: count of the arena at the last reset
         
     public:
         
@@ -119,26 +720,159 @@ namespace lan
         /* Erases a bit. */
         void erase_bit(db_bit *);
         
+        /* Destroys the payloads and indexes of every bit in the context, their memory goes with arena.release(). */
+        void discard_bits(db_bits *);
+        
+        /* Discards every bit and releases the arena at once. */
+        void release_bits();
+        
+        /* Erases the payload, bits and indexes of a bit (keeps it linked in its context). */
+        void clear_bit(db_bit *);
+        
         /* Resets pointers and variables of the class. */
         void reset_data();
         
+        /* Moves to a new structure, so every handle resolves its path again. */
+        void restructure();
+        
         /* Erases current loaded bits and frees memory. */
         void erase();
         
         /* The database is empty. */
         bool empty();
         
+        /*! @brief Enables or disables lazy pulls (text format only): arrays and containers are parsed on first access.
+         *  Note: The pulled file is kept in memory until every pending bit is parsed (or erased). */
+        void set_lazy(bool);
+        
+        /*! @brief Sets the number of threads used to pull text files (1: single thread, 0: one per core). */
+        void set_threads(size_t);
+        
+        /*! @brief Gets the bits of an array or container, parsing them first if they are pending (lazy pull). */
+        lan::db_bits * expand(lan::db_bit * bit){
+            if(bit->pending) expand_pending(bit);
+            return bit->lin;
+        }
+        
+        /*! @brief Parses the bits of a pending array or container, dependece. */
+        void expand_pending(lan::db_bit *);
+        
+        /*! @brief Parses every pending array and container. */
+        void expand_all(lan::db_bits * = nullptr);
+        
+        /*! @brief Forgets the pending bits of a bit, dependece. */
+        void drop_pending(lan::db_bit *);
+        
+        /*! @brief Gets the statistics of the allocator that owns the bits of the database. */
+        lan::db_arena_stats allocator_stats() const;
+        
+        /*! @brief Gets the operation counters of the database.
+         *  Note: Counters are only kept when landb is built with LANDB_STATS (cmake -DLANDB_STATS=ON), they stay at zero otherwise. */
+        lan::db_stats stats() const;
+        
+        /*! @brief Sets the operation counters of the database to zero. */
+        void reset_stats();
+        
+        /*! @brief Enables or disables the reader/writer mode: get, get_p and push take a shared lock and run
+         *  through the const lookup path, every other public method that changes the database takes an exclusive lock.
+         *  Note: Pending bits are parsed and lookup structures are built when enabled (and after each pull).
+         *  Note: Enable it before other threads use the database, and only disable it once they stopped: the locks
+         *  are chosen by the mode, so a thread that already skipped the lock isn't waited for. */
+        void set_concurrent(bool);
+        
+        /*! @brief Takes a shared lock when concurrent (no lock otherwise). */
+        std::shared_lock<std::shared_mutex> read_lock() const {
+            return (concurrent) ? std::shared_lock<std::shared_mutex>(mutex) : std::shared_lock<std::shared_mutex>();
+        }
+        
+        /*! @brief Takes an exclusive lock when concurrent (no lock otherwise), snapshots can't be changed.
+         @param keep    The bits are kept (false: the caller replaces them all, a snapshot sharing them takes them without a copy).
+         */
+        std::unique_lock<std::shared_mutex> write_lock(bool keep = true){
+            if(frozen) throw lan::errors::frozen_error("LANDB (frozen_error): Unable to change a snapshot.");
+            std::unique_lock<std::shared_mutex> lock = (concurrent) ? std::unique_lock<std::shared_mutex>(mutex) : std::unique_lock<std::shared_mutex>();
+            generation++;
+            if(shared) unshare(keep);
+            return lock;
+        }
+        
+        /*! @brief Takes an exclusive lock when concurrent (no lock otherwise), for changes that leave the bits as they are. */
+        std::unique_lock<std::shared_mutex> exclusive_lock(){
+            if(frozen) throw lan::errors::frozen_error("LANDB (frozen_error): Unable to change a snapshot.");
+            return (concurrent) ? std::unique_lock<std::shared_mutex>(mutex) : std::unique_lock<std::shared_mutex>();
+        }
+        
+        /*! @brief Readers can't change the bits (concurrent, a snapshot, or bits shared with one): they use lookup instead of find_any. */
+        bool read_only() const {
+            return concurrent or frozen or shared;
+        }
+        
+        /*! @brief Gets an immutable view of the database, readers can use it (through get and get_p) while writers change the database.
+         *  Note: The view shares the bits of the database, in constant time, until the next change of the database copies them
+         *  (once, and only if someone still holds the view). A change then moves every bit: pointers from get_p taken before it
+         *  point into the view. Unsafe bits read as missing in a view. Writes through pointers from get_p aren't changes: a view
+         *  taken before them may be returned after them. */
+        std::shared_ptr<lan::db> snapshot();
+        
+        /*! @brief Gives the bits shared with the last snapshot to it, and copies them back if they are kept, dependece. */
+        void unshare(bool keep);
+        
+        /*! @brief Copies a list of bits of another database into this one, dependece.
+         @param origin  The database that owns the bits.
+         @param bits    The bits.
+         @param context The context of the copies.
+         @param adopt   Unsafe payloads are taken over from origin.retained (otherwise Unsafe bits are copied without data).
+         */
+        lan::db_bits * copy_bits(lan::db & origin, lan::db_bits * bits, lan::db_bit * context, bool adopt = false);
+        
+        /*! @brief Drops the Unsafe payloads of a list of bits, without changing the bits (a snapshot may still read them), dependece. */
+        void drop_unsafe(lan::db_bits *);
+        
+        /*! @brief Builds the indexes and array stores that readers use, dependece. */
+        void prepare_lookups(lan::db_bits *, lan::db_bit * context = nullptr);
+        
+        /*! @brief Enables or disables the per context hash indexes (enabled by default).
+         *  Note: Contexts with less than db_index_threshold bits are never indexed. */
+        void set_indexing(bool);
+        
         /*! Prints the bits of the current context (default context: main from *first).
          *  @param tabs Used by the system.
          *  @param  bit The bit to start printing from.
+         *  @param sizes Prints the bytes used by each bit (and by the bits of arrays and containers), see memory_usage.
+         */
+        void print(size_t tabs = 0 , lan::db_bit * bit = nullptr, bool sizes = false);
+        
+        /*! @brief Print dependece, adds the lines of a list of bits (and their bits), gets the bytes and number of the bits it measured. */
+        std::pair<size_t, size_t> print_bits(size_t tabs, lan::db_bit * bits, bool sizes, std::vector<std::string> & lines);
+        
+        /*! @brief Adds the bytes used by a bit (and its bits, when deep) to a memory usage, dependece. */
+        void measure(lan::db_bit const *, lan::db_memory_usage &, bool deep = true) const;
+        
+        /*! @brief Gets the bytes used by an array or container and its bits, by type of bit.
+         @param name    The array or container ("" for the main context, "@" for the anchor, dotted addresses for inner containers).
+         Note: Walks the bits, allocator_stats() gives the bytes reserved by the whole database in constant time.
+         Eg: size_t bytes = any.memory_usage("PersonA.Grades").overall.total();
          */
-        void print(size_t tabs = 0 , lan::db_bit * bit = nullptr);
+        lan::db_memory_usage memory_usage(std::string_view const name = "");
         
         /* File */
         
-        /* Connects the database to a file, to pull and push from. */
+        /* Connects the database to a file, to pull and push from (*.ldbb files use the binary format). */
         bool connect(std::string);
         
+        /* Connects the database to a file, to pull and push from, in a certain format. */
+        bool connect(std::string, lan::db_format);
+        
+        /* Gets the format of a file from its extension. */
+        static lan::db_format format_of(std::string const);
+        
+        /*! @brief Converts a database file between formats (chosen by extension), losslessly.
+         @param source  The file to read from (false if it doesn't exist, or has no bits but isn't empty).
+         @param target  The file to write to.
+         Eg: lan::db::convert("data.ldb", "data.ldbb");
+         */
+        static bool convert(std::string const source, std::string const target);
+        
         /* Database is connected to a file. */
         bool is_connected();
         
@@ -179,7 +913,7 @@ namespace lan
         std::string prepare_string_to_read(std::string);
         
         /*! @brief Pull dependece. */
-        void * get_var_data(db_bit_type, std::string);
+        void * get_var_data(db_bit *, std::string);
         
         /*! @brief Pull dependece. */
         lan::db_bit  * read_var_bit(std::string const, db_bit_type const, std::string &);
@@ -193,9 +927,123 @@ namespace lan
         /*! @brief Pull dependece. */
         lan::db_bits * read_all_bits(std::string);
         
+        /*! @brief Pull dependece. */
+        std::string & prepare_string_to_read(std::string_view, std::string &);
+        
+        /*! @brief Pull dependece. */
+        void * read_var_data(db_bit *, std::string_view);
+        
+        /*! @brief Pull dependece, reads a number straight from the buffer (0 if it isn't a number).
+         Eg: double d = read_number<double>("1.5");
+         */
+        template<typename any>
+        static any read_number(std::string_view data){
+            any value = 0;
+            if(data.length() and data.front() == '+') data.remove_prefix(1);
+            std::from_chars(data.data(), data.data() + data.length(), value);
+            return value;
+        }
+        
+        /*! @brief Pull dependece. */
+        lan::db_bit * parse_container_bit(lan::db_cursor &, bool = false);
+        
+        /*! @brief Pull dependece. */
+        lan::db_bit * parse_array_bit(std::string_view, lan::db_cursor &);
+        
+        /*! @brief Pull dependece, parses the bits of an array until its end. */
+        lan::db_bits * parse_array_data(lan::db_cursor &, lan::db_bit *);
+        
+        /*! @brief Pull dependece, skips the bits of an array or container (lazy pull). */
+        void parse_pending(lan::db_cursor &, lan::db_bit *);
+        
+        /*! @brief Pull dependece. */
+        lan::db_bit * parse_value_bit(lan::db_cursor &, bool = false);
+        
+        /*! @brief Pull dependece. */
+        lan::db_bit * parse_bit(lan::db_cursor &);
+        
+        /*! @brief Pull dependece, parses every bit of a context until its end (links them to the context). */
+        lan::db_bits * parse_bits(lan::db_cursor &, lan::db_bit * = nullptr);
+        
+        /*! @brief Pull dependece, parses a landb-structure in a single pass. */
+        lan::db_bits * parse_all_bits(std::string_view);
+        
+        /*! @brief Pull dependece, parses a landb-structure on several threads (blocks of whole bits, big arrays and containers
+         *  split as well, are parsed in parallel, then linked). Falls back to a single thread when it can't be split or a block fails. */
+        lan::db_bits * parse_all_bits(std::string_view, size_t threads);
+        
+        /*! @brief Pull dependece, splits the bits of a context in blocks of about <size> bytes, scanning brackets and quotes only.
+         @param content The landb-structure.
+         @param offset  The start of the bits, left after the bracket that closes the context.
+         @param parent  The task of the context (npos: main context).
+         @param size    The size of a block.
+         @param plan    The tasks, in order.
+         @return false when the structure can't be split (it's then parsed on one thread, which reports its errors).
+         */
+        static bool plan_pull(std::string_view content, size_t & offset, size_t parent, size_t size, std::vector<lan::db_pull_task> & plan);
+        
+        /*! @brief Pull dependece, gets the start of the first bit after a blank in [from, to) of text without brackets or quotes (npos if none). */
+        static size_t split_point(std::string_view, size_t from, size_t to);
+        
+        /*! @brief Pull dependece, reads the key and type of the array or container opened by the bracket at <at>.
+         @param start   Gets the start of the bit (not before <from>).
+         @param offset  Gets the start of its bits.
+         */
+        static bool read_list_header(std::string_view content, size_t from, size_t at, bool in_array, lan::db_pull_task & task, size_t & start, size_t & offset);
+        
+        /*! @brief Pull dependece, parses a block of a parallel pull into bits of a context (nullptr: main context). */
+        void parse_block(lan::db_pull_task &, lan::db_bit * context);
+        
+        /*! @brief Pull dependece, reads a binary unsigned integer. */
+        static uint64_t read_varint(std::string_view, size_t &);
+        
+        /*! @brief Pull dependece, reads a binary little-endian number of a certain size. */
+        static uint64_t read_fixed(std::string_view, size_t &, size_t);
+        
+        /*! @brief Pull dependece, reads a binary string (length-prefixed). */
+        static std::string_view read_binary_string(std::string_view, size_t &);
+        
+        /*! @brief Pull dependece, reads a binary bit. */
+        lan::db_bit * parse_binary_bit(std::string_view, size_t &);
+        
+        /*! @brief Pull dependece, reads binary bits until the end of a context (links them to the context). */
+        lan::db_bits * parse_binary_bits(std::string_view, size_t &, lan::db_bit * = nullptr);
+        
+        /*! @brief Pull dependece, reads a binary database (.ldbb). */
+        lan::db_bits * parse_all_binary_bits(std::string_view);
+        
         /*! @brief Pulls data from the connected file. Note: This operaion erases all bits */
         bool pull();
         
+        /*! @brief Push dependece, writes the unparsed block of a pending bit as it was pulled (false if not pending). */
+        bool write_pending(db_bit *, lan::db_sink &);
+        
+        /*! @brief Push dependece.*/
+        void write_container_bit(db_bit *, lan::db_sink &);
+        
+        /*! @brief Push dependece.*/
+        void write_array_bit(db_bit *, lan::db_sink &);
+        
+        /*! @brief Push dependece.*/
+        void prepare_string_to_write(std::string_view, lan::db_sink &);
+        
+        /*! @brief Push dependece.*/
+        void write_var_bit(db_bit *, lan::db_sink &, bool = false);
+        
+        /*! @brief Push dependece, writes a number in its shortest form that reads back to the same value. */
+        template<typename any>
+        static void write_number(any value, lan::db_sink & sink){
+            char number [64];
+            std::to_chars_result result = std::to_chars(number, number + sizeof(number), value);
+            sink.write(std::string_view(number, result.ptr - number));
+        }
+        
+        /*! @brief Push dependece.*/
+        void write_bit(db_bit *, lan::db_sink &, bool = false);
+        
+        /*! @brief Push dependece.*/
+        void write_all_bits(db_bits *, lan::db_sink &);
+        
         /*! @brief Push dependece.*/
         std::string write_container_bit(db_bit *);
         
@@ -217,19 +1065,105 @@ namespace lan
         /*! @brief Push dependece.*/
         std::string write_all_bits(db_bits *);
         
-        /*! @brief Pushes data to the current file, in landb-structure.*/
+        /*! @brief Push dependece, writes a binary unsigned integer. */
+        static void write_varint(uint64_t, lan::db_sink &);
+        
+        /*! @brief Push dependece, writes a binary bit. */
+        void write_binary_bit(db_bit *, lan::db_sink &);
+        
+        /*! @brief Push dependece, writes a binary database (.ldbb). */
+        void write_all_binary_bits(db_bits *, lan::db_sink &);
+        
+        /*! @brief Push dependece, writes a range of sibling bits [begin, end). */
+        void write_range(lan::db_push_task const &, lan::db_format, lan::db_sink &);
+        
+        /*! @brief Push dependece, counts the bits of a bit (itself included), bottom-up, keeping the count of every array and container in <sizes>. */
+        static size_t count_bits(lan::db_bit const *, lan::db_bit_sizes & sizes);
+        
+        /*! @brief Push dependece, splits a list of bits in tasks of about <size> bits (big arrays and containers are split too), <sizes> comes from count_bits. */
+        void plan_bits(lan::db_bits *, bool in_array, size_t size, lan::db_format, lan::db_bit_sizes const & sizes, std::vector<lan::db_push_task> &);
+        
+        /*! @brief Push dependece, writes every bit to a sink on several threads (same output as write_all). */
+        void write_all(lan::db_sink &, lan::db_format, size_t threads);
+        
+        /*! @brief Pushes data to the current file, in landb-structure.
+         *  Note: When journaling, only the mutations since the last push are appended to the journal. */
         bool push();
         
+        /*! @brief Pushes data to a sink (eg: a file descriptor or a user buffer), in landb-structure.*/
+        bool push(lan::db_sink &);
+        
+        /*! @brief Pushes data to a sink, in a certain format.*/
+        bool push(lan::db_sink &, lan::db_format);
+        
+        /*! @brief Pushes a snapshot of the database to the current file in the background, writers are not blocked (the first
+         *  change during the push copies the bits once, see snapshot).
+         *  Note: When journaling, the journal is appended before returning. */
+        std::future<bool> push_async();
+        
+        /*! @brief Push dependece, writes every bit to a sink (without locking). */
+        bool write_all(lan::db_sink &, lan::db_format);
+        
+        /* Journal */
+        
+        /*! @brief Enables or disables the journal: set, remove, declare and iterate are recorded, push appends
+         *  the records to a sidecar file (<file>.journal) and pull replays them over the file.
+         *  Note: Writes through a get_p pointer aren't recorded, set the bit again (or compact) to keep them. */
+        void set_journal(bool);
+        
+        /*! @brief Rewrites the connected file with every bit and truncates the journal. */
+        bool compact();
+        
+        /*! @brief Records a mutation in the journal (when journaling), dependece.
+         @param op      The operation.
+         @param target  The context, array or bit the operation applies to (nullptr: main context).
+         @param bit     The bit that was written.
+         @param index   The index of the bit (journal_set_index).
+         */
+        bool log(lan::db_journal_op op, lan::db_bit * target, lan::db_bit * bit = nullptr, size_t index = 0){
+            return (not journaling) or log_record(op, target, bit, index);
+        }
+        
+        /*! @brief Journal dependece. */
+        bool log_record(lan::db_journal_op, lan::db_bit *, lan::db_bit *, size_t);
+        
+        /*! @brief Journal dependece, writes the path from the main context to a bit. */
+        void write_path(lan::db_bit *, lan::db_sink &);
+        
+        /*! @brief Journal dependece, resolves a path written by write_path. */
+        bool read_path(std::string_view, size_t &, lan::db_bit *&);
+        
+        /*! @brief Journal dependece, applies the records of a journal. */
+        size_t replay(std::string_view);
+        
+        /*! @brief Journal dependece, applies a journal record. */
+        void replay_record(std::string_view);
+        
+        /*! @brief Links a detached bit at the end of a context (nullptr: main context), dependece. */
+        bool link_bit(lan::db_bit * context, lan::db_bit * bit);
+        
+        /*! @brief Copies the value of a variable bit (same type, read as the C++ type of the bit type; Unsafe values aren't copied), dependece. */
+        void copy_data(lan::db_bit * target, lan::db_bit * source);
+        
         /* Error handling */
         
         /*! @brief General dependece */
-        std::string error_string(errors::_private::error_type, std::string const);
+        std::string error_string(errors::_private::error_type, std::string const) const;
         
         /* db general */
         
         /*! @brief Updates the *last pointer */
         bool update_last(){return (last = (first and last) ? last : get_last_bit(first));}
         
+        /*! @brief Gets the last bit of a context (nullptr: main context), walking it only if its tail isn't known, dependece. */
+        lan::db_bit * get_tail(lan::db_bit * context);
+        
+        /*! @brief Counts the bits of a context without changing it: constant time once its tail is known, dependece. */
+        size_t count_of(const lan::db_bit * context) const;
+        
+        /*! @brief Appends a bit to the end of a context (nullptr: main context) in constant time, dependece. */
+        void attach(lan::db_bit * context, lan::db_bit * bit);
+        
         /*! @brief Sets a variable bit, depence.
          @param context The context of the variable.
          @param var     The bit that will be set.
@@ -238,106 +1172,85 @@ namespace lan
          @param value   The literal value of the bit.
          */
         template<typename any>
-        bool set_bit(db_bit * context, db_bit * var,std::string const name, db_bit_type const type, any const value){
-            set_bit(context, var, name, type);
-            var->data = new any (value);
-            return (var->data);
-        }
-        
-        /*! @brief Sets a bit, dependece.
-         @param context The context of the variable.
-         @param var     The bit that will be set.
-         @param name    The name of the bit.
-         @param type    The type of the bit.
-         */
-        bool set_bit(db_bit * context, db_bit * var,std::string const name, db_bit_type const type){
-            var->~db_bit();
-            var->key  = name;
-            var->type = type;
-            var->con = context;
-            return  (var);
+        bool set_bit(db_bit * context, db_bit * var, std::string name, db_bit_type const type, any value){
+            set_bit(context, var, std::move(name), type);
+            return (set_data(var, std::move(value)));
         }
         
-        /*! @brief Inits the *first bit, dependece.
-         @param name    The name of the bit.
-         @param value   The literal value of the bit.
-         @param type    The type of the bit.
+        /*! @brief Stores the value of a variable bit (inline for scalar types), dependece.
+         @param var     The bit, already typed and without data.
+         @param value   The literal value of the bit (moved into the bit).
          */
         template<typename any>
-        bool init(std::string const name, any const value, db_bit_type const type){
-            data = new db_bit;
-            return (first = last = data) and ((type < lan::Array) ? set_bit(nullptr, data, name, type, value) : set_bit(nullptr ,data, name, type));
+        void * set_data(db_bit * var, any value){
+            return make_data<any>(var, std::move(value));
         }
         
-        /*! @brief Inits the *first bit of a context, dependece.
-         @param context The context.
-         @param name    The name of the bit.
-         @param value   The literal value of the bit.
-         @param type    The type of the bit.
+        /*! @brief Builds the value of a variable bit in place (inline for scalar types), dependece.
+         @param var         The bit, already typed and without data.
+         @param arguments   The arguments of a constructor of <any>.
          */
-        template<typename any>
-        bool init(lan::db_bit * context, std::string const name, any const value, db_bit_type const type){
-            data = context;
-            data->lin = new db_bit;
-            return ((type < lan::Array) ? set_bit(data, data->lin, name, type, value) : set_bit(data, data->lin, name, type));
+        template<typename any, typename... args>
+        void * make_data(db_bit * var, args &&... arguments){
+            if constexpr (lan::db_bit_type_v<any> < lan::String) {
+                var->value.x = 0;
+                new (&var->value) any (std::forward<args>(arguments)...);
+                return (var->data = &var->value);
+            } else if constexpr (std::is_trivially_copyable<any>::value and sizeof(any) <= sizeof(db_bit_value)) {
+                if(var->type < lan::String){
+                    var->value.x = 0;
+                    new (&var->value) any (std::forward<args>(arguments)...);
+                    return (var->data = &var->value);
+                }
+            } if(var->type == lan::Unsafe)  // kept apart, a copy of shared bits takes it over (see unshare)
+                return (var->data = arena.make<any, true>(std::forward<args>(arguments)...));
+            return (var->data = arena.make<any>(std::forward<args>(arguments)...));
         }
         
-        /*! @brief Appends a bit in the main context, dependece.
-         @param name    The name of the bit.
-         @param value   The literal value of the bit.
-         @param type    The type of the bit.
-         */
-        template<typename any>
-        bool append(std::string const name, any const value, db_bit_type const type){
-            last = get_last_bit(first);
-            last->nex = new db_bit; last->nex->pre = last;
-            return (last=last->nex) and ((type < lan::Array) ? set_bit(nullptr, last, name, type, value) : set_bit(nullptr, last, name, type));
+        /*! @brief Drops the value of a variable bit, dependece. */
+        void drop_data(db_bit * var){
+            if(var->data and not var->inlined()) arena.drop(var->data);
+            var->data = nullptr;
         }
         
-        /*! @brief Appends a bit in a context, dependece.
-         @param context The context.
+        /*! @brief Sets a bit, dependece.
+         @param context The context of the variable.
+         @param var     The bit that will be set.
          @param name    The name of the bit.
-         @param value   The literal value of the bit.
          @param type    The type of the bit.
          */
-        template<typename any>
-        bool append(lan::db_bit * context, std::string const name, any const value, db_bit_type const type){
-            data = context;
-            if(data-> type == lan::Container and (data = data->lin)){
-                data = get_last_bit(data);
-                data->nex = new db_bit; data->nex->pre = data; data = data->nex;
-                return ((type < lan::Array) ? set_bit(context, data, name, type, value) : set_bit(context, data, name, type));
-            } return false;
+        bool set_bit(db_bit * context, db_bit * var, std::string name, db_bit_type const type){
+            if(var->type == type and var->con == context and not var->key.empty() and var->key == name){
+                drop_data(var);
+                return (var);
+            }
+            if(not var->key.empty()) unindex_bit(var);
+            clear_bit(var);
+            var->key  = std::move(name);
+            var->type = type;
+            var->con = context;
+            return  (index_bit(var));
         }
         
-        /*! @brief Inits a bit in a context, dependece.
-         @param context The context.
-         @param name    The name of the bit.
-         @param value   The literal value of the bit.
+        /*! @brief Appends a new bit to a context in constant time and sets it, dependece (data points to the new bit).
+         @param context The array or container (nullptr: main context).
+         @param name    The name of the bit ("" in arrays).
+         @param value   The literal value of the bit (ignored for arrays and containers).
          @param type    The type of the bit.
          */
         template<typename any>
-        bool init_iter(lan::db_bit * context, std::string const name, any const value, db_bit_type const type){
-            data = context;
-            data->lin = new db_bit; data = data->lin;
-            return ((type < lan::Array) ? set_bit(context, data, name, type, value) : set_bit(context, data, name, type));
+        bool insert(lan::db_bit * context, std::string name, any value, db_bit_type const type){
+            attach(context, data = arena.make_bit());
+            return ((type < lan::Array) ? set_bit(context, data, std::move(name), type, std::move(value)) : set_bit(context, data, std::move(name), type));
         }
         
-        /*! @brief Appends a bit in a context, dependece.
-         @param context The context.
+        /*! @brief Finds a variable bit of a context, or appends it, and leaves it without data, dependece.
+         @param context The context (nullptr: main context).
          @param name    The name of the bit.
-         @param value   The literal value of the bit.
-         @param type    The ype of the bit.
+         @param type    The type of the bit.
+         Note: An existing bit is reused, its data is dropped (overwritten, see emplace).
          */
-        template<typename any>
-        bool append_iter(lan::db_bit * context, std::string const name, any const value, db_bit_type const type){
-            data = context;
-            if(context->type == lan::Array and (data = data->lin)){
-                data = get_last_bit(data);
-                data->nex = new db_bit; data->nex->pre = data; data = data->nex;
-                return ((type < lan::Array) ? set_bit(context, data, name, type, value) : set_bit(context, data, name, type));
-            } return false;
-        }
+        lan::db_bit * place(lan::db_bit * context, std::string name, db_bit_type const type);
         
         /*! @brief Appends a bit in an array.
          @param target  The array.
@@ -345,11 +1258,13 @@ namespace lan
          @param type    The type of the bit.
          */
         template<typename any>
-        bool iterate(std::string const target, any const value, db_bit_type const type){
-            if((data = find_rec(target, lan::Container, lan::Array, first))) {
-                return (data->lin) ? append_iter(data, "", value, type) :
-                init_iter(data, "", value, type);
-            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, target+"{a}"));
+        bool iterate(std::string_view const target, any value, db_bit_type const type){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            lan::db_bit * array;
+            if((array = data = find_rec(target, lan::Container, lan::Array, first))) {
+                expand(data);
+                return insert(array, "", std::move(value), type) and log(journal_iterate, array, data);
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(target)+"{a}"));
         }
         
         /*! @brief Declares an array or container bit in the main context.
@@ -362,19 +1277,34 @@ namespace lan
          @param name    The name of the bit.
          @param type    The type of the bit.
          */
-        bool declare(std::string const target, std::string const name, db_bit_type const type);
+        bool declare(std::string_view const target, std::string const name, db_bit_type const type);
+        
+        /*! @brief Index dependece, gets the index of the context that *ref belongs to (nullptr if it isn't indexed). */
+        lan::db_index * get_context_index(lan::db_bit * context);
+        
+        /*! @brief Index dependece, builds the index of a context (nullptr: main context). */
+        lan::db_index * build_context_index(lan::db_bit * context);
+        
+        /*! @brief Index dependece, drops every index in a list of bits. */
+        void drop_indexes(lan::db_bits *);
+        
+        /*! @brief Index dependece, adds a bit to the index of its context. */
+        bool index_bit(lan::db_bit *);
+        
+        /*! @brief Index dependece, removes a bit from the index of its context. */
+        void unindex_bit(lan::db_bit *);
         
         /*! @brief Global dependece. */
-        std::string find__pop_address(std::string &);
+        std::string_view find__pop_address(std::string_view &);
         
         /*! @brief Global dependece. */
         lan::db_bit * find(std::string const, lan::db_bit *);
         
         /*! @brief Global dependece. */
-        lan::db_bit * find_rec(std::string, lan::db_bit_type const , lan::db_bit *);
+        lan::db_bit * find_rec(std::string_view, lan::db_bit_type const , lan::db_bit *);
         
         /*! @brief Global dependece. */
-        lan::db_bit * find_rec(std::string, lan::db_bit_type const , lan::db_bit_type const, lan::db_bit *);
+        lan::db_bit * find_rec(std::string_view, lan::db_bit_type const , lan::db_bit_type const, lan::db_bit *);
         
         /*! @brief Global dependece. */
         lan::db_bit * find_var(std::string const, lan::db_bit *);
@@ -383,33 +1313,79 @@ namespace lan
         lan::db_bit * find_non_var(std::string const, lan::db_bit *);
         
         /*! @brief Global dependece. */
-        lan::db_bit * find_any(std::string const, lan::db_bit_type const, lan::db_bit *);
+        lan::db_bit * find_any(std::string_view const, lan::db_bit_type const, lan::db_bit *);
+        
+        /* Path */
+        
+        /*! @brief Finds the bit at a path (every step but the last is a Container).
+         @param target  The path.
+         @param type    The type of the bit.
+         @param steps   The number of steps to follow (all by default).
+         */
+        lan::db_bit * resolve(lan::path const & target, lan::db_bit_type const type, size_t steps = std::string::npos);
+        
+        /*! @brief Gets the bit of a handle, resolving its path again if bits were erased since it was resolved. */
+        lan::db_bit * resolve(lan::handle & target);
+        
+        /* Lookup */
+        
+        /*! @brief Finds a bit in a list of bits without changing the database (reentrant).
+         *  Note: Pending bits are not parsed and indexes are not built, existing ones are used. */
+        const lan::db_bit * lookup(std::string_view name, lan::db_bit_type const type, const lan::db_bit * ref) const;
+        
+        /*! @brief Finds a bit by address ("a.b.c") without changing the database (reentrant).
+         @param address     The address, every step but the last is a <type> bit.
+         @param type        The type of the steps.
+         @param final_type  The type of the last step.
+         */
+        const lan::db_bit * lookup(std::string_view address, lan::db_bit_type const type, lan::db_bit_type const final_type, const lan::db_bit * ref) const;
+        
+        /*! @brief Finds a bit of an array without changing the database (reentrant). */
+        const lan::db_bit * lookup(const lan::db_bits * array, size_t index) const;
+        
+        /*! @brief Get dependece, finds a bit of the main context (through lookup when concurrent). */
+        const lan::db_bit * search(std::string_view const name, lan::db_bit_type const type);
+        
+        /*! @brief Get dependece, finds a bit of a context (through lookup when concurrent). */
+        const lan::db_bit * search(std::string_view const context, std::string_view const name, lan::db_bit_type const type);
+        
+        /*! @brief Get dependece, finds a bit of an array of the main context (through lookup when concurrent). */
+        const lan::db_bit * search(std::string_view const name, size_t index);
         
         /* Get */
         
         /*! @brief Gets data from a variable bit in the main context.
          @param name    The name of the bit.
          @param type    The type of the bit.
+         Note: <any> must be the C++ type of <type> (db_bit_type_v) or <type> Unsafe, the gets by type assert it in debug builds.
          Eg: any.get<int>(...);
          */
         template<typename any>
-        any get(std::string const name, const lan::db_bit_type type){
-            if((data = find_any(name, type, first)) and data->data and type < lan::Array){
-                any * data_p = (any*)data->data;
+        any get(std::string_view const name, const lan::db_bit_type type){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = search(name, type)) and bit->data and type < lan::Array){
+                assert(holds<any>(bit->type));
+                any * data_p = (any*)bit->data;
                 return ((any&)*data_p);
-            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, name));
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(name)));
         }
         
         /*! @brief Gets *data from a variable bit in the main context.
          @param name    The name of the bit.
          @param type    The type of the bit.
+         Note: Writing through the pointer doesn't count as a change, so snapshot() may keep returning an older copy,
+         and the journal doesn't record it (see set_journal).
          Eg: int * p = any.get_p<int>(...);
          */
         template<typename any>
-        any * get_p(std::string const name, const lan::db_bit_type type){
-            if((data = find_any(name, type, first)) and data->data and type < lan::Array){
-                return (any*)data->data;
-            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, name));
+        any * get_p(std::string_view const name, const lan::db_bit_type type){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = search(name, type)) and bit->data and type < lan::Array){
+                assert(holds<any>(bit->type));
+                return (any*)bit->data;
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(name)));
         }
         
         /*! @brief Gets data from a variable bit from an array in the main context.
@@ -419,15 +1395,14 @@ namespace lan
          Eg: any.get<int>(...);
          */
         template<typename any>
-        any get(std::string const name, size_t index, const lan::db_bit_type type){
-            if((data = find_any(name, lan::Array, first))){
-                data=data->lin;
-                for(register_t it = 0 ; (it < index) and data ; it++, data=data->nex);
-                if(data and data->type == type){
-                    any * data_p = (any*)data->data;
-                    return ((any&)*data_p);
-                } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, name+"["+std::to_string(index)+"]"));
-            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, name));
+        any get(std::string_view const name, size_t index, const lan::db_bit_type type){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = search(name, index)) and bit->type == type){
+                assert(holds<any>(bit->type));
+                any * data_p = (any*)bit->data;
+                return ((any&)*data_p);
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(name)+"["+std::to_string(index)+"]"));
         }
         
         /*! @brief gets *data from an array in the main context.
@@ -437,14 +1412,13 @@ namespace lan
          Eg: int * p = any.get_p<int>(...);
          */
         template<typename any>
-        any * get_p(std::string const name, size_t index, const lan::db_bit_type type){
-            if((data = find_any(name, lan::Array, first))){
-                data=data->lin;
-                for(register_t it = 0 ; (it < index) and data ; it++, data=data->nex);
-                if(data and data->type == type){
-                    return (any*)data->data;
-                } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, name+"["+std::to_string(index)+"]"));
-            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, name));
+        any * get_p(std::string_view const name, size_t index, const lan::db_bit_type type){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = search(name, index)) and bit->type == type){
+                assert(holds<any>(bit->type));
+                return (any*)bit->data;
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(name)+"["+std::to_string(index)+"]"));
         }
         
         /*! @brief Gets data from a variable bit in a certain context.
@@ -454,13 +1428,14 @@ namespace lan
          Eg: any.get<int>(...);
          */
         template<typename any>
-        any get(std::string context, std::string const name, const lan::db_bit_type type){
-            if ((data = find_rec(context, lan::Container, first))) {
-                if((data = find_any(name, type, data->lin)) and data->data){
-                    any * data_p = (any*)data->data;
-                    return ((any&)*data_p);
-                }
-            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, name));
+        any get(std::string_view const context, std::string_view const name, const lan::db_bit_type type){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = search(context, name, type)) and bit->data){
+                assert(holds<any>(bit->type));
+                any * data_p = (any*)bit->data;
+                return ((any&)*data_p);
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(name)));
         }
         
         /*! @brief Gets *data from a variable bit in a certain context.
@@ -470,14 +1445,75 @@ namespace lan
          Eg: int * p = any.get_p<int>(...);
          */
         template<typename any>
-        any * get_p(std::string context, std::string const name, const lan::db_bit_type type){
-            if ((data = find_rec(context, lan::Container, first))) {
-                if((data = find_any(name, type, data->lin)) and data->data){
-                    return (any*)data->data;
-                }
-            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, name));
+        any * get_p(std::string_view const context, std::string_view const name, const lan::db_bit_type type){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = search(context, name, type)) and bit->data){
+                assert(holds<any>(bit->type));
+                return (any*)bit->data;
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(name)));
+        }
+        
+        
+        /*! @brief Gets data from a variable bit at a path.
+         @param target  The path.
+         @param type    The type of the bit.
+         Eg: any.get<int>(lan::path("Person.Age"), lan::Int);
+         */
+        template<typename any>
+        any get(lan::path const & target, const lan::db_bit_type type){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = resolve(target, type)) and bit->data and type < lan::Array){
+                assert(holds<any>(bit->type));
+                any * data_p = (any*)bit->data;
+                return ((any&)*data_p);
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, target.str()));
+        }
+        
+        /*! @brief Gets *data from a variable bit at a path.
+         @param target  The path.
+         @param type    The type of the bit.
+         Eg: int * p = any.get_p<int>(lan::path("Person.Age"), lan::Int);
+         */
+        template<typename any>
+        any * get_p(lan::path const & target, const lan::db_bit_type type){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = resolve(target, type)) and bit->data and type < lan::Array){
+                assert(holds<any>(bit->type));
+                return (any*)bit->data;
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, target.str()));
+        }
+        
+        /*! @brief Gets data from the variable bit of a handle.
+         @param target  The handle.
+         Eg: lan::handle age ("Person.Age", lan::Int); any.get<int>(age);
+         */
+        template<typename any>
+        any get(lan::handle & target){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = resolve(target)) and bit->data and target.type < lan::Array){
+                assert(holds<any>(bit->type));
+                any * data_p = (any*)bit->data;
+                return ((any&)*data_p);
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, target.path.str()));
         }
         
+        /*! @brief Gets *data from the variable bit of a handle.
+         @param target  The handle.
+         Eg: int * p = any.get_p<int>(age);
+         */
+        template<typename any>
+        any * get_p(lan::handle & target){
+            std::shared_lock<std::shared_mutex> lock = read_lock();
+            const lan::db_bit * bit;
+            if((bit = resolve(target)) and bit->data and target.type < lan::Array){
+                assert(holds<any>(bit->type));
+                return (any*)bit->data;
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, target.path.str()));
+        }
         
         /*! @brief Gets data from a variable bit.
          @param bit   The bit.
@@ -502,7 +1538,99 @@ namespace lan
             } return 0;
         }
         
-        /*! @brief Get dependece. */
+        /*! @brief Checks that a bit of a type can be read as <any>, dependece (Unsafe bits store any type). */
+        template<typename any>
+        static constexpr bool holds(lan::db_bit_type type){
+            return type == lan::Unsafe or type == lan::db_bit_type_v<any>;
+        }
+        
+        /*! @brief Gets the type of the bits that store <any>, dependece (Unsafe bits need an explicit type). */
+        template<typename any>
+        static constexpr lan::db_bit_type typed(){
+            static_assert(lan::db_bit_type_v<any> != lan::Unsafe, "LANDB: no bit type for this C++ type, pass a lan::db_bit_type");
+            return lan::db_bit_type_v<any>;
+        }
+        
+        /*! @brief Gets data from a variable bit in the main context, typed by <any>.
+         @param name    The name of the bit.
+         Eg: any.get<int>("Age");
+         */
+        template<typename any>
+        any get(std::string_view const name){
+            return get<any>(name, typed<any>());
+        }
+        
+        /*! @brief Gets *data from a variable bit in the main context, typed by <any>.
+         @param name    The name of the bit.
+         Eg: int * p = any.get_p<int>("Age");
+         */
+        template<typename any>
+        any * get_p(std::string_view const name){
+            return get_p<any>(name, typed<any>());
+        }
+        
+        /*! @brief Gets data from a variable bit from an array in the main context, typed by <any>.
+         @param name    The name of the array.
+         @param index   The index of the bit.
+         Eg: any.get<int>("Grades", 0);
+         */
+        template<typename any>
+        any get(std::string_view const name, size_t index){
+            return get<any>(name, index, typed<any>());
+        }
+        
+        /*! @brief Gets *data from a variable bit from an array in the main context, typed by <any>.
+         @param name    The name of the array.
+         @param index   The index of the bit.
+         Eg: int * p = any.get_p<int>("Grades", 0);
+         */
+        template<typename any>
+        any * get_p(std::string_view const name, size_t index){
+            return get_p<any>(name, index, typed<any>());
+        }
+        
+        /*! @brief Gets data from a variable bit in a context, typed by <any>.
+         @param context The context.
+         @param name    The name of the bit.
+         Eg: any.get<int>("Person", "Age");
+         */
+        template<typename any>
+        any get(std::string_view const context, std::string_view const name){
+            return get<any>(context, name, typed<any>());
+        }
+        
+        /*! @brief Gets *data from a variable bit in a context, typed by <any>.
+         @param context The context.
+         @param name    The name of the bit.
+         Eg: int * p = any.get_p<int>("Person", "Age");
+         */
+        template<typename any>
+        any * get_p(std::string_view const context, std::string_view const name){
+            return get_p<any>(context, name, typed<any>());
+        }
+        
+        /*! @brief Gets data from a variable bit at a path, typed by <any>.
+         @param target  The path.
+         Eg: any.get<int>(lan::path("Person.Age"));
+         */
+        template<typename any>
+        any get(lan::path const & target){
+            return get<any>(target, typed<any>());
+        }
+        
+        /*! @brief Gets *data from a variable bit at a path, typed by <any>.
+         @param target  The path.
+         Eg: int * p = any.get_p<int>(lan::path("Person.Age"));
+         */
+        template<typename any>
+        any * get_p(lan::path const & target){
+            return get_p<any>(target, typed<any>());
+        }
+        
+        /*! @brief Get dependece, gets the element store of an array (built on first use). */
+        lan::db_array * get_array_items(lan::db_bits *);
+        
+        /*! @brief Get dependece, gets a bit from an array in constant time. */
         lan::db_bit * get_array_bit(lan::db_bits *, size_t);
         
         /*! @brief Get dependece. */
@@ -525,12 +1653,13 @@ namespace lan
          Eg: any.get<int>(...);
          */
         template<typename any>
-        bool set(std::string const name, any const value, lan::db_bit_type type, bool overwrite = false){
+        bool set(std::string name, any value, lan::db_bit_type type, bool overwrite = false){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
             if(type >= lan::Array) return false;
             if((data = find_any(name, type, first))){
                 if(not overwrite) throw lan::errors::overriding_bit_error(error_string(errors::_private::_overriding_bit_error, data->key));
-                return set_bit(nullptr,data, name, type, value);
-            } return (not first) ? init(name, value, type) : append(name, value, type);
+                return set_bit(nullptr, data, std::move(name), type, std::move(value)) and log(journal_set, nullptr, data);
+            } return insert(nullptr, std::move(name), std::move(value), type) and log(journal_set, nullptr, last);
         }
         
         /*! @brief Sets a variable bit in an array.
@@ -540,19 +1669,21 @@ namespace lan
          Eg: any.get<int>(...);
          */
         template<typename any>
-        bool set(std::string array, size_t index,  any const value, lan::db_bit_type type){
-            if((data = find_rec(array, lan::Container, lan::Array, first))){
-                data=data->lin;
-                for(register_t it = 0 ; (it < index) and data ; it++, data=data->nex);
-                if(data){
-                    if(data->data)
-                        data->~db_bit();
-                    data->type = type;
+        bool set(std::string_view const array, size_t index,  any value, lan::db_bit_type type){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            lan::db_bit * target, * bit;
+            if((target = find_rec(array, lan::Container, lan::Array, first))){
+                if((bit = get_array_bit(target, index))){
+                    if(bit->data or bit->lin or bit->pending)
+                        clear_bit(bit);
+                    unindex_bit(bit);
+                    bit->type = type;
+                    index_bit(bit);
                     if(type < lan::Array)
-                        data->data = new any (value);
-                    return true;
-                } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, array+"["+std::to_string(index)+"]"));
-            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, array+"{Array}"));
+                        set_data(bit, std::move(value));
+                    return log(journal_set_index, target, bit, index);
+                } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(array)+"["+std::to_string(index)+"]"));
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(array)+"{Array}"));
         }
         
         /*! @brief Sets a variable bit in a context.
@@ -564,15 +1695,167 @@ namespace lan
          Eg: any.get<int>(...);
          */
         template<typename any>
-        bool set(std::string const context, std::string const name, any const value, lan::db_bit_type type, bool overwrite = false){
+        bool set(std::string_view const context, std::string name, any value, lan::db_bit_type type, bool overwrite = false){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
             if(type >= lan::Array) return false;
             if((data = find_rec(context, lan::Container, first))){
                 lan::db_bit * buffer = data;
-                if((data = find_any(name, type, data->lin))) {
+                if((data = find_any(name, type, expand(data)))) {
                     if(!overwrite) throw lan::errors::overriding_bit_error(error_string(errors::_private::_overriding_bit_error, data->key));
-                    return set_bit(buffer, data, name, type, value);
-                } return (buffer->lin) ? append(buffer, name, value, type) : init(buffer, name, value, type);
-            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, context+"{Container}"));;
+                    return set_bit(buffer, data, std::move(name), type, std::move(value)) and log(journal_set, buffer, data);
+                } return insert(buffer, std::move(name), std::move(value), type) and log(journal_set, buffer, data);
+            } throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(context)+"{Container}"));
+        }
+        
+        /*! @brief Sets a variable bit at a path (every step but the last is a Container).
+         @param target  The path.
+         @param value   The value of the bit.
+         @param type    The type of the bit.
+         @param overwrite   Flag to override an existing bit with the same name and type.
+         Eg: any.set<int>(lan::path("Person.Age"), 21, lan::Int, true);
+         */
+        template<typename any>
+        bool set(lan::path const & target, any value, lan::db_bit_type type, bool overwrite = false){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            return set_path(target, std::move(value), type, overwrite);
+        }
+        
+        /*! @brief Sets a variable bit at a path under the lock of the caller, dependece (see set(lan::path const &, any, lan::db_bit_type, bool)). */
+        template<typename any>
+        bool set_path(lan::path const & target, any value, lan::db_bit_type type, bool overwrite){
+            lan::db_bit * context = nullptr;
+            std::string name (target.back());
+            if(type >= lan::Array or not target.size()) return false;
+            if(target.size() > 1 and not (context = resolve(target, lan::Container, target.size() - 1)))
+                throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, target.str()+"{Container}"));
+            if((data = find_any(name, type, (context) ? expand(context) : first))){
+                if(not overwrite) throw lan::errors::overriding_bit_error(error_string(errors::_private::_overriding_bit_error, data->key));
+                return set_bit(context, data, std::move(name), type, std::move(value)) and log(journal_set, context, data);
+            } return insert(context, std::move(name), std::move(value), type) and log(journal_set, context, data);
+        }
+        
+        /*! @brief Sets the variable bit of a handle (created if it doesn't exist).
+         @param target  The handle.
+         @param value   The value of the bit.
+         @param overwrite   Flag to override the bit if it exists.
+         Note: <any> must store the type of the handle (db_bit_type_v), only Unsafe handles take any type, otherwise a bit_name_error is thrown.
+         Eg: any.set<int>(age, 22);
+         */
+        template<typename any>
+        bool set(lan::handle & target, any value, bool overwrite = true){
+            if(target.type != lan::Unsafe and target.type < lan::Array and target.type != lan::db_bit_type_v<any>)
+                throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, target.path.str()));
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            lan::db_bit * bit;
+            if(target.type >= lan::Array) return false;
+            if((bit = resolve(target))){
+                if(not overwrite) throw lan::errors::overriding_bit_error(error_string(errors::_private::_overriding_bit_error, bit->key));
+                drop_data(bit);
+                return set_data(bit, std::move(value)) and log(journal_set, bit->con, bit);
+            } return set_path(target.path, std::move(value), target.type, overwrite);
+        }
+        
+        /*! @brief Sets a variable bit in the main context, typed by <any> (an existing bit throws overriding_bit_error, see assign).
+         @param name    The name of the bit.
+         @param value   The value of the bit.
+         Eg: any.set<int>("Age", 21);
+         */
+        template<typename any>
+        bool set(std::string name, any value){
+            return set(std::move(name), std::move(value), typed<any>(), false);
+        }
+        
+        /*! @brief Sets a variable bit in an array, typed by <any>.
+         @param array   The array.
+         @param index   The index of the bit.
+         @param value   The value of the bit.
+         Eg: any.set<int>("Grades", 0, 14);
+         */
+        template<typename any>
+        bool set(std::string_view const array, size_t index, any value){
+            return set(array, index, std::move(value), typed<any>());
+        }
+        
+        /*! @brief Sets a variable bit in a context, typed by <any> (an existing bit throws overriding_bit_error, see assign).
+         @param context The context.
+         @param name    The name of the bit.
+         @param value   The value of the bit.
+         Eg: any.set<int>("Person", "Age", 21);
+         */
+        template<typename any>
+        bool set(std::string_view const context, std::string name, any value){
+            return set(context, std::move(name), std::move(value), typed<any>(), false);
+        }
+        
+        /*! @brief Sets a variable bit at a path, typed by <any> (an existing bit throws overriding_bit_error, see assign).
+         @param target  The path.
+         @param value   The value of the bit.
+         Eg: any.set<int>(lan::path("Person.Age"), 21);
+         */
+        template<typename any>
+        bool set(lan::path const & target, any value){
+            return set(target, std::move(value), typed<any>(), false);
+        }
+        
+        /*! @brief Sets or overwrites a variable bit in the main context, typed by <any>.
+         @param name    The name of the bit.
+         @param value   The value of the bit.
+         Eg: any.assign<int>("Age", 21);
+         */
+        template<typename any>
+        bool assign(std::string name, any value){
+            return set(std::move(name), std::move(value), typed<any>(), true);
+        }
+        
+        /*! @brief Sets or overwrites a variable bit in a context, typed by <any>.
+         @param context The context.
+         @param name    The name of the bit.
+         @param value   The value of the bit.
+         Eg: any.assign<int>("Person", "Age", 21);
+         */
+        template<typename any>
+        bool assign(std::string_view const context, std::string name, any value){
+            return set(context, std::move(name), std::move(value), typed<any>(), true);
+        }
+        
+        /*! @brief Sets or overwrites a variable bit at a path, typed by <any>.
+         @param target  The path.
+         @param value   The value of the bit.
+         Eg: any.assign<int>(lan::path("Person.Age"), 21);
+         */
+        template<typename any>
+        bool assign(lan::path const & target, any value){
+            return set(target, std::move(value), typed<any>(), true);
+        }
+        
+        /*! @brief Sets (or overwrites) a variable bit in the main context, building its value in place.
+         @param name        The name of the bit.
+         @param arguments   The arguments of a constructor of <any>.
+         Note: Like assign, an existing bit is always overwritten (the arguments leave no room for an overwrite flag), set throws overriding_bit_error instead.
+         Eg: any.emplace<std::string>("Line", 80, '-');
+         */
+        template<typename any, typename... args>
+        bool emplace(std::string name, args &&... arguments){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            lan::db_bit * bit = place(nullptr, std::move(name), typed<any>());
+            return make_data<any>(bit, std::forward<args>(arguments)...) and log(journal_set, nullptr, bit);
+        }
+        
+        /*! @brief Sets (or overwrites) a variable bit at a path, building its value in place.
+         @param target      The path (every step but the last is a Container).
+         @param arguments   The arguments of a constructor of <any>.
+         Note: Like assign, an existing bit is always overwritten (the arguments leave no room for an overwrite flag), set throws overriding_bit_error instead.
+         Eg: any.emplace<std::string>(lan::path("Person.Name"), std::move(name));
+         */
+        template<typename any, typename... args>
+        bool emplace(lan::path const & target, args &&... arguments){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            lan::db_bit * context = nullptr, * bit;
+            if(not target.size()) return false;
+            if(target.size() > 1 and not (context = resolve(target, lan::Container, target.size() - 1)))
+                throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, target.str()+"{Container}"));
+            bit = place(context, std::string(target.back()), typed<any>());
+            return make_data<any>(bit, std::forward<args>(arguments)...) and log(journal_set, context, bit);
         }
         
         /*! @brief Sets the anchor, aka "@", to a specific bit. Depending in how it's used, an anchor may potentialy speed up the program.
@@ -580,19 +1863,26 @@ namespace lan
          @param index   The index that we will be pointing to.
          Note: Anchors can't be variables, only Containers and Arrays are supported.
          */
-        lan::anchor_t * set_anchor(std::string const array, size_t index){
-            if ((data = find_rec(array, lan::Container, lan::Array, first)) and
-                (anchor = get_array_bit(data, index))) return anchor;
-            else throw lan::errors::anchor_name_error(error_string(errors::_private::_anchor_name_error, array+"["+std::to_string(index)+"]"));
+        lan::anchor_t * set_anchor(std::string_view const array, size_t index){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            restructure();
+            if ((data = find_rec(array, lan::Container, lan::Array, first)) and (anchor = get_array_bit(data, index))){
+                journal_element = anchor;
+                journal_index = index;
+                journal_structure = structure;
+                return anchor;
+            } else throw lan::errors::anchor_name_error(error_string(errors::_private::_anchor_name_error, std::string(array)+"["+std::to_string(index)+"]"));
         }
         
         /*! @brief Sets the anchor, aka "@", to a specific bit. Depending in how it's used, an anchor may potentialy speed up the program.
          @param context The context.
          Note: Anchors can't be variables, only Containers and Arrays are supported.
          */
-        lan::anchor_t * set_anchor(std::string const context){
+        lan::anchor_t * set_anchor(std::string_view const context){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            restructure();
             if ((data = find_rec(context, lan::Container, first)) || (data = find_rec(context, lan::Array, first))) return (anchor = data);
-            else throw lan::errors::anchor_name_error(error_string(errors::_private::_anchor_name_error, context));
+            else throw lan::errors::anchor_name_error(error_string(errors::_private::_anchor_name_error, std::string(context)));
         }
         
         /*! @brief Sets the anchor, aka "@", to a specific bit. Depending in how it's used, an anchor may potentialy speed up the program.
@@ -600,6 +1890,8 @@ namespace lan
          Note: Anchors can't be variables, only Containers and Arrays are supported.
          */
         lan::anchor_t * set_anchor(lan::anchor_t * anchor){
+            std::unique_lock<std::shared_mutex> lock = write_lock();
+            restructure();
             if ((this->anchor = anchor) && (anchor->type == lan::Array || anchor->type == lan::Container))
                 return anchor;
             else if (!anchor) throw lan::errors::anchor_name_error(error_string(errors::_private::_anchor_name_error, "nullptr"));
@@ -607,6 +1899,134 @@ namespace lan
             return nullptr;
         }
         
+        /* Items */
+        
+        /*! @brief Finds an array or container ("" for the main context, which gives nullptr; "@" for the anchor), dependece. */
+        lan::db_bit * search_list(std::string_view const name);
+        
+        /*! @brief Gets the first bit of an array or container ("" for the main context, "@" for the anchor), dependece. */
+        lan::db_bit * items_head(std::string_view const name);
+        
+        /*! @brief Gets the number of bits of an array or container ("" for the main context, "@" for the anchor).
+         @param name    The array or container.
+         Note: Constant time, once the bits were walked or appended to.
+         Eg: for(size_t i = 0 ; i < any.size("List") ; i++) ...;
+         */
+        size_t size(std::string_view const name);
+        
+        /*! @brief Gets the bits of an array or container, in order.
+         @param name    The array or container ("" for the main context, "@" for the anchor).
+         Note: Like get_p, the range is only safe to use while no writer touches those bits.
+         Eg: for(lan::db_bit & bit : any.items("Person")) std::cout << bit.key;
+         */
+        lan::db_range<> items(std::string_view const name);
+        
+        /*! @brief Gets the bits of one type of an array or container, in order.
+         @param name    The array or container.
+         @param type    The type of the bits.
+         */
+        lan::db_range<> items(std::string_view const name, lan::db_bit_type const type);
+        
+        /*! @brief Gets the values of the bits typed by <any> of an array or container, in order.
+         @param name    The array or container.
+         Eg: for(std::string & name : any.items<std::string>("List")) ...;
+         */
+        template<typename any>
+        lan::db_range<any> items(std::string_view const name){
+            return lan::db_range<any>(items_head(name), true, typed<any>());
+        }
+        
+        /* Batch */
+        
+        /// @brief Fields of one container, found once for many gets and sets (see db::batch), only gets when const.
+        class fields {
+            lan::db & database;
+            lan::db_bit * context;
+            mutable std::vector<std::string> missing;
+            
+        public:
+            
+            fields(lan::db & database, lan::db_bit * context) : database(database), context(context){}
+            
+            /*! @brief Gets data from a field; a missing field is reported by db::batch and reads as any().
+             @param name    The name of the bit.
+             @param type    The type of the bit.
+             */
+            template<typename any>
+            any get(std::string_view const name, const lan::db_bit_type type) const {
+                const lan::db_bit * bit = (database.read_only()) ? database.lookup(name, type, context->lin) : database.find_any(name, type, context->lin);
+                if(bit and bit->data and type < lan::Array){
+                    assert(lan::db::holds<any>(bit->type));
+                    return *(any*)bit->data;
+                } missing.emplace_back(name);
+                return any();
+            }
+            
+            /*! @brief Gets data from a field, typed by <any>. */
+            template<typename any>
+            any get(std::string_view const name) const {
+                return get<any>(name, lan::db::typed<any>());
+            }
+            
+            /*! @brief Sets (or overwrites) a field.
+             @param name    The name of the bit.
+             @param value   The value of the bit.
+             @param type    The type of the bit.
+             */
+            template<typename any>
+            bool set(std::string name, any value, lan::db_bit_type type){
+                lan::db_bit * bit;
+                if(type >= lan::Array) return false;
+                if((bit = database.find_any(name, type, context->lin)))
+                    return database.set_bit(context, bit, std::move(name), type, std::move(value)) and database.log(journal_set, context, bit);
+                return database.insert(context, std::move(name), std::move(value), type) and database.log(journal_set, context, database.data);
+            }
+            
+            /*! @brief Sets (or overwrites) a field, typed by <any>. */
+            template<typename any>
+            bool set(std::string name, any value){
+                return set(std::move(name), std::move(value), lan::db::typed<any>());
+            }
+            
+            /*! @brief Gets the names of the fields that were not found. */
+            std::vector<std::string> const & failures() const {
+                return missing;
+            }
+        };
+        
+        /*! @brief Finds a container once and hands its fields to a visitor, for many gets and sets under one lock.
+         @param context The container (or "@").
+         @param visit   Callable as visit(lan::db::fields &), or as visit(lan::db::fields const &) to only get (under the shared lock, snapshots included).
+         Note: gets of missing fields are reported together, with one bit_name_error after the visitor returns.
+         Eg: any.batch("@", [](lan::db::fields & person){ person.set<int>("Age", 21); person.get<std::string>("Name"); });
+         */
+        template<typename visitor>
+        bool batch(std::string_view const context, visitor visit){
+            if constexpr (std::is_invocable_v<visitor, lan::db::fields const &>){
+                std::shared_lock<std::shared_mutex> lock = read_lock();
+                const lan::db_bit * target;
+                if(read_only()) target = lookup(context, lan::Container, lan::Container, first);
+                else if((target = find_rec(context, lan::Container, first))) expand((lan::db_bit *)target);
+                if(not target or target->pending)
+                    throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(context)+"{Container}"));
+                lan::db::fields const found (*this, (lan::db_bit *)target);
+                visit(found);
+                return check_batch(context, found);
+            } else {
+                std::unique_lock<std::shared_mutex> lock = write_lock();
+                lan::db_bit * target;
+                if(not (target = find_rec(context, lan::Container, first)))
+                    throw lan::errors::bit_name_error(error_string(errors::_private::_bit_name_error, std::string(context)+"{Container}"));
+                expand(target);
+                lan::db::fields found (*this, target);
+                visit(found);
+                return check_batch(context, found);
+            }
+        }
+        
+        /*! @brief Throws one bit_name_error for the missing fields of a batch, dependece. */
+        bool check_batch(std::string_view const context, lan::db::fields const & found);
+        
         /* Remove */
         
         /*! @brief Removes a bit.
@@ -620,13 +2040,24 @@ namespace lan
          @param name The name of the bit.
          @param type The type of the bit.
          */
-        bool remove(std::string const context, std::string const name, db_bit_type const type);
+        bool remove(std::string_view const context, std::string const name, db_bit_type const type);
         
         /*! @brief Removes a bit.
          @param array The array.
          @param index The index of the bit in array.
          */
-        bool remove(std::string const array, size_t index);
+        bool remove(std::string_view const array, size_t index);
+        
+        /*! @brief Removes the bit at a path.
+         @param target The path.
+         @param type The type of the bit.
+         */
+        bool remove(lan::path const & target, db_bit_type const type);
+        
+        /*! @brief Removes the bit of a handle.
+         @param target The handle.
+         */
+        bool remove(lan::handle & target);
         
         /* -- */
         
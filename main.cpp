@@ -34,21 +34,27 @@ int main (int argc, const char * argv []) {
     
     students.set_anchor("Carlos", 0);
     
-    students.set<std::string>("@", "Full_name", "Carlos Eduard" ,lan::String, true);
-    students.set<double>("@", "Average", 13 ,lan::Double, true);
-    students.set<bool>("@", "Passed", true ,lan::Bool, true);
+    students.batch("@", [](lan::db::fields & student){
+        student.set<std::string>("Full_name", "Carlos Eduard");
+        student.set<double>("Average", 13);
+        student.set<bool>("Passed", true);
+    });
     
     students.set_anchor("Anna", 0);
     
-    students.set<std::string>("@", "Full_name", "Anna Cristin" ,lan::String, true);
-    students.set<double>("@", "Average", 16 ,lan::Double, true);
-    students.set<bool>("@", "Passed", true ,lan::Bool, true);
+    students.batch("@", [](lan::db::fields & student){
+        student.set<std::string>("Full_name", "Anna Cristin");
+        student.set<double>("Average", 16);
+        student.set<bool>("Passed", true);
+    });
     
     students.set_anchor("Antony", 0);
     
-    students.set<std::string>("@", "Full_name", "Antony Jeff" ,lan::String, true);
-    students.set<double>("@", "Average", 9 ,lan::Double, true);
-    students.set<bool>("@", "Passed", false ,lan::Bool, true);
+    students.batch("@", [](lan::db::fields & student){
+        student.set<std::string>("Full_name", "Antony Jeff");
+        student.set<double>("Average", 9);
+        student.set<bool>("Passed", false);
+    });
     
     students.connect("generated_example.ldb");
         
@@ -56,19 +62,21 @@ int main (int argc, const char * argv []) {
     
     std::cout << "Landia::db version: " << lan::db_version << "; Hello world!\n";
     
-    std::string current_student;
+    size_t i = 0;
     
-    for( auto i : { 0, 1, 2}){
-                current_student = students.get<std::string>("List", i, lan::String);
+    for(std::string const & current_student : students.items<std::string>("List")){
                 students.set_anchor(current_student, 0);
-                std::cout << "info: Printing description for student <" << current_student << ">"
-                << std::endl
-                << i + 1 <<".\tName: " << students.get<std::string>("@", "Full_name", lan::String) 
-                << std::endl
-                << "\tAverage : " <<  students.get<double>("@", "Average", lan::Double)
-                << std::endl
-                << "\tPassed : " <<  ((students.get<bool>("@", "Passed", lan::Bool) ? "Yes" : "No"))
-                << std::endl;
+                students.batch("@", [&](lan::db::fields const & student){
+                    std::cout << "info: Printing description for student <" << current_student << ">"
+                    << std::endl
+                    << i + 1 <<".\tName: " << student.get<std::string>("Full_name")
+                    << std::endl
+                    << "\tAverage : " <<  student.get<double>("Average")
+                    << std::endl
+                    << "\tPassed : " <<  ((student.get<bool>("Passed") ? "Yes" : "No"))
+                    << std::endl;
+                });
+                i++;
         }
     
     students.push();
@@ -0,0 +1,702 @@
+/*
+ * version = d : 1.0
+ * file = s : "tests.cpp"
+ * project = s : "landb"
+ *
+ * (credits:
+ *          message = s : "Created by René Descartes Domingos Muala on 10/10/20."
+ *          Copyright = s : "© 2021 landia (René Muala). All rights reserved."
+ *          Contact = s : "renemuala@icloud.com"
+ * )
+ *
+ * usage = s : "landb_tests [test ...]"
+ */
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "landb.hpp"
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Fails the running test when a condition is false. */
+#define check(condition) if(not (condition)) throw std::runtime_error(std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": " + #condition)
+
+/* A landb-structure using every type, nesting and escaping. */
+const std::string test_content =
+    "Name=s:\"Landia \\\"db\\\" \\\\ end\" Flag=b:1 Count=i:-42 Big=l:1234567890 Huge=x:-9876543210123 Ratio=f:0.5 Pi=d:3.141592653589793 Letter=c:\"q\"\n"
+    "List=a:[ s:\"Carlos\" i:7 a:[ i:1 i:2 ] (: Passed=b:1 Average=d:13.5 ) ]\n"
+    "(Person: Name=s:\"Ty\" Age=i:9 (Address: City=s:\"Maputo\" Zip=a:[ i:1100 ] ) )\n";
+
+/* Writes <content> to a file. */
+void make_file(std::string const & name, std::string const & content){
+    lan::safe_file file;
+    file.open(name);
+    file.push(content);
+}
+
+/* Pulls a file and pushes it to a string, as text. */
+std::string text_of(std::string const & name){
+    lan::db database;
+    std::string output;
+    {
+        lan::db_sink sink(output);
+        database.connect(name);
+        database.pull();
+        database.push(sink);
+    } return output;
+}
+
+/* Checks the values of test_content. */
+void check_content(lan::db & database){
+    check(database.get<std::string>("Name") == "Landia \"db\" \\ end");
+    check(database.get<bool>("Flag") == true);
+    check(database.get<int>("Count") == -42);
+    check(database.get<long>("Big") == 1234567890);
+    check(database.get<long long>("Huge") == -9876543210123);
+    check(database.get<float>("Ratio") == 0.5f);
+    check(database.get<double>("Pi") == 3.141592653589793);
+    check(database.get<char>("Letter") == 'q');
+    check(database.get<std::string>("List", 0) == "Carlos");
+    check(database.get<int>("List", 1) == 7);
+    check(database.get<int>("Person", "Age") == 9);
+    check(database.get<std::string>("Person.Address", "City") == "Maputo");
+    check(database.size("List") == 4);
+}
+
+/* Pulls, pushes and pulls again: values and text survive unchanged. */
+void test_roundtrip(){
+    std::string first, second;
+    make_file("landb_tests.ldb", test_content);
+    {
+        lan::db database;
+        database.connect("landb_tests.ldb");
+        check(database.pull());
+        check_content(database);
+        check(database.push());
+    } first = text_of("landb_tests.ldb");
+    {
+        lan::db database;
+        database.connect("landb_tests.ldb");
+        check(database.pull());
+        check_content(database);
+        check(database.push());
+    } second = text_of("landb_tests.ldb");
+    check(first == second);
+    std::remove("landb_tests.ldb");
+}
+
+/* Converts text to binary and back: values and text survive unchanged. */
+void test_convert(){
+    std::string original;
+    make_file("landb_tests.ldb", test_content);
+    original = text_of("landb_tests.ldb");
+    check(lan::db::convert("landb_tests.ldb", "landb_tests.ldbb"));
+    {
+        lan::db database;
+        database.connect("landb_tests.ldbb");
+        check(database.pull());
+        check_content(database);
+    } std::remove("landb_tests.ldb");
+    check(lan::db::convert("landb_tests.ldbb", "landb_tests.ldb"));
+    check(text_of("landb_tests.ldb") == original);
+    std::remove("landb_tests.ldb");
+    std::remove("landb_tests.ldbb");
+    check(not lan::db::convert("landb_tests.ldb", "landb_tests.ldbb"));
+    check(std::fopen("landb_tests.ldbb", "r") == nullptr);
+}
+
+/* A snapshot keeps its values while the database changes. */
+void test_snapshot(){
+    lan::db database;
+    std::shared_ptr<lan::db> view;
+    make_file("landb_tests.ldb", test_content);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    std::remove("landb_tests.ldb");
+    view = database.snapshot();
+    check(database.snapshot() == view);
+    database.assign<int>("Count", 1);
+    database.assign<std::string>("Person", "Name", "Renato");
+    database.remove("List", 0);
+    check(view->get<int>("Count") == -42);
+    check(view->get<std::string>("Person", "Name") == "Ty");
+    check(view->get<std::string>("List", 0) == "Carlos");
+    check(database.snapshot() != view);
+    check(database.snapshot()->get<int>("Count") == 1);
+}
+
+/* A snapshot shares the bits until a change made while it's held, which copies them once. */
+void test_snapshot_shared(){
+    lan::db database;
+    std::shared_ptr<lan::db> view;
+    int * count;
+    make_file("landb_tests.ldb", test_content);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    database.set<int>("Raw", 5, lan::Unsafe);
+    database.set<std::vector<int>>("Vector", std::vector<int>(3, 1), lan::Unsafe);
+    count = database.get_p<int>("Count");
+    database.snapshot();
+    database.assign<int>("Count", 1);
+    check(database.get_p<int>("Count") == count);
+    view = database.snapshot();
+    check(view->get_p<int>("Count") == count);
+    check(view->allocator_stats().bits == 0);
+    database.assign<int>("Count", 2);
+    check(database.get_p<int>("Count") != count);
+    check(*count == 1);
+    check(database.get<int>("Raw", lan::Unsafe) == 5);
+    check(database.get<std::vector<int>>("Vector", lan::Unsafe).size() == 3);
+    try {
+        view->get<int>("Raw", lan::Unsafe);
+        check(false);
+    } catch (lan::errors::bit_name_error &) {}
+    view = database.snapshot();
+    database.pull();
+    std::remove("landb_tests.ldb");
+    check(view->get<int>("Count") == 2);
+    check(database.get<int>("Count") == -42);
+    {
+        lan::db other;
+        other.assign<int>("Count", 3);
+        view = other.snapshot();
+    } check(view->get<int>("Count") == 3);
+}
+
+/* A lazy database is expanded whole, and a snapshot nobody holds is freed. */
+void test_snapshot_lazy(){
+    lan::db database;
+    std::weak_ptr<lan::db> released;
+    make_file("landb_tests.ldb", test_content);
+    database.set_lazy(true);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    std::remove("landb_tests.ldb");
+    released = database.snapshot();
+    check(released.expired());
+    check_content(*database.snapshot());
+    check(database.memory_usage().overall.pending == 0);
+}
+
+/* A typed set refuses to overwrite a bit, as the set taking a type does, assign overwrites it. */
+void test_set_typed(){
+    lan::db database;
+    database.set<int>("Age", 21);
+    database.set<int>(lan::path("Age2"), 1);
+    for(std::function<void()> overwrite : std::vector<std::function<void()>> {
+        [&](){ database.set<int>("Age", 22); },
+        [&](){ database.set<int>("Age", 22, lan::Int); },
+        [&](){ database.set<int>(lan::path("Age2"), 2); }}){
+        try {
+            overwrite();
+            check(false);
+        } catch (lan::errors::overriding_bit_error &) {}
+    } check(database.get<int>("Age") == 21);
+    check(database.assign<int>("Age", 22));
+    check(database.assign<int>(lan::path("Age2"), 2));
+    check(database.get<int>("Age") == 22);
+    check(database.get<int>("Age2") == 2);
+    check(database.size("") == 2);
+}
+
+/* Items walk the bits of a list both ways, filtered by type or as values. */
+void test_items(){
+    lan::db database;
+    make_file("landb_tests.ldb", test_content);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    std::remove("landb_tests.ldb");
+    std::vector<lan::db_bit_type> types;
+    for(lan::db_bit & bit : database.items("List"))
+        types.push_back(bit.type);
+    check((types == std::vector<lan::db_bit_type> {lan::String, lan::Int, lan::Array, lan::Container}));
+    check(database.items("List").size() == database.size("List"));
+    check(database.items("").size() == database.size(""));
+    check(database.items("List", lan::Array).size() == 1);
+    check(database.items("List", lan::Bool).empty());
+    lan::db_range<> list = database.items("List");
+    check((--list.end())->type == lan::Container);
+    check(std::prev(database.items("List", lan::Int).end())->type == lan::Int);
+    check(std::prev(database.items("List", lan::Int).end()) == database.items("List", lan::Int).begin());
+    for(int & value : database.items<int>("List"))
+        value++;
+    check(database.get<int>("List", 1) == 8);
+    std::vector<std::string> names (database.items<std::string>("Person").begin(), database.items<std::string>("Person").end());
+    check((names == std::vector<std::string> {"Ty"}));
+    database.set_anchor("List", 3);
+    check(database.items<double>("@").begin().get()->key == "Average");
+    check(*std::max_element(database.items<double>("@").begin(), database.items<double>("@").end()) == 13.5);
+}
+
+/* A handle resolved by a database finds the bit of any other database it is used on. */
+void test_handle(){
+    lan::db first, second;
+    lan::handle age ("Person.Age", lan::Int);
+    make_file("landb_tests.ldb", test_content);
+    first.connect("landb_tests.ldb");
+    first.pull();
+    second.connect("landb_tests.ldb");
+    second.pull();
+    std::remove("landb_tests.ldb");
+    second.assign<int>("Person", "Age", 10);
+    check(first.get<int>(age) == 9);
+    check(second.get<int>(age) == 10);
+    check(first.snapshot()->get<int>(age) == 9);
+    first.set<int>(age, 11);
+    check(first.get<int>(age) == 11);
+    check(second.get<int>(age) == 10);
+}
+
+/* A handle sets only values of its type and adds its bit when it is missing. */
+void test_handle_set(){
+    lan::db database;
+    lan::handle age ("Person.Age", lan::Int), weight ("Person.Weight", lan::Int), note ("Person.Note", lan::Unsafe);
+    make_file("landb_tests.ldb", test_content);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    std::remove("landb_tests.ldb");
+    try {
+        database.set<std::string>(age, "nine");
+        check(false);
+    } catch (lan::errors::bit_name_error &) {}
+    check(database.get<int>(age) == 9);
+    check(database.set<int>(weight, 30));
+    check(database.get<int>("Person", "Weight") == 30);
+    check(database.size("Person") == 4);
+    check(database.set<std::string>(note, "quiet"));
+    check(database.get<std::string>(note) == "quiet");
+}
+
+/* A batch that only gets works on a snapshot and doesn't count as a change. */
+void test_batch_read(){
+    lan::db database;
+    std::shared_ptr<lan::db> view;
+    make_file("landb_tests.ldb", test_content);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    std::remove("landb_tests.ldb");
+    view = database.snapshot();
+    database.batch("Person", [](lan::db::fields const & person){
+        check(person.get<int>("Age") == 9);
+    });
+    check(database.snapshot() == view);
+    view->batch("Person.Address", [](lan::db::fields const & address){
+        check(address.get<std::string>("City") == "Maputo");
+    });
+    try {
+        view->batch("Person", [](lan::db::fields const & person){ person.get<int>("Height"); });
+        check(false);
+    } catch (lan::errors::bit_name_error &) {}
+    try {
+        view->batch("Person", [](lan::db::fields & person){ person.set<int>("Age", 10); });
+        check(false);
+    } catch (lan::errors::frozen_error &) {}
+}
+
+/* Setting an element of an array over an element with bits of its own. */
+void test_set_index(){
+    lan::db database;
+    make_file("landb_tests.ldb", test_content);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    std::remove("landb_tests.ldb");
+    database.set<int>("List", 2, 5);
+    database.set<int>("List", 3, 6);
+    check(database.get<int>("List", 2) == 5);
+    check(database.get<int>("List", 3) == 6);
+    check(database.size("List") == 4);
+}
+
+/* The context indexes keep the first of duplicate keys and follow removals and type changes. */
+void test_index_shadowed(){
+    std::string content = "Dup=i:1 ";
+    lan::db database;
+    for(int i = 0 ; i < 20 ; i++)
+        content += "Value" + std::to_string(i) + "=i:" + std::to_string(i) + " ";
+    content += "Dup=i:2 (Group: Dup=s:\"a\" ";
+    for(int i = 0 ; i < 20 ; i++)
+        content += "Value" + std::to_string(i) + "=i:" + std::to_string(i) + " ";
+    content += "Dup=s:\"b\" ) List=a:[ i:1 (: Dup=i:3 Dup=i:4 ) ]";
+    make_file("landb_tests.ldb", content);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    std::remove("landb_tests.ldb");
+    check(database.get<int>("Value19") == 19);
+    check(database.get<int>("Dup") == 1);
+    check(database.get<int>("Group", "Value19") == 19);
+    check(database.get<std::string>("Group", "Dup") == "a");
+    database.remove("Dup", lan::Int);
+    database.remove("Group", "Dup", lan::String);
+    check(database.get<int>("Dup") == 2);
+    check(database.get<std::string>("Group", "Dup") == "b");
+    database.set_anchor("List", 1);
+    check(database.get<int>("@", "Dup") == 3);
+    database.set<std::string>("List", 0, "one");
+    check(database.get<std::string>("List", 0) == "one");
+    database.set<int>("List", 1, 5);
+    check(database.get<int>("List", 1) == 5);
+    check(database.size("List") == 2);
+}
+
+/* A pull that fails halfway leaves no bits or payloads behind. */
+void test_pull_error(){
+    lan::db database;
+    make_file("landb_tests.ldb", "Name=s:\"a string too long for the small string buffer\" List=a:[ s:\"another string too long to be stored inline\" (: x=i:1 ) ] (Broken x=i:1 )");
+    database.connect("landb_tests.ldb");
+    try {
+        database.pull();
+        check(false);
+    } catch (lan::errors::pull_error &) {}
+    std::remove("landb_tests.ldb");
+    check(database.allocator_stats().bits == 0);
+    check(database.allocator_stats().payloads == 0);
+    check(database.empty());
+}
+
+/* An erase releases every slab and large payload, and resets the counters of the arena. */
+void test_arena_release(){
+    lan::db database;
+    database.set<std::string>("Long", std::string(1000, 'x'));
+    database.set<std::string>("Short", "a string too long to be stored inline");
+    database.declare("Group", lan::Container);
+    database.set<int>("Group", "x", 1);
+    check(database.allocator_stats().bits == 4);
+    check(database.allocator_stats().payloads == 2);
+    check(database.allocator_stats().reserved > 1000);
+    database.erase();
+    check(database.allocator_stats().slabs == 0);
+    check(database.allocator_stats().reserved == 0);
+    check(database.allocator_stats().used == 0);
+    check(database.allocator_stats().bits == 0);
+    check(database.allocator_stats().payloads == 0);
+    database.set<std::string>("Long", std::string(1000, 'y'));
+    check(database.get<std::string>("Long") == std::string(1000, 'y'));
+    check(database.allocator_stats().payloads == 1);
+}
+
+/* A pending block that fails to parse stays pending, and is pushed back as it was. */
+void test_lazy_error(){
+    lan::db database;
+    std::string output;
+    make_file("landb_tests.ldb", "(P: x=i:1 (Q x=i:2 ) ) Z=i:3");
+    database.set_lazy(true);
+    database.connect("landb_tests.ldb");
+    check(database.pull());
+    std::remove("landb_tests.ldb");
+    for(int i = 0 ; i < 2 ; i++){
+        try {
+            database.get<int>("P", "x");
+            check(false);
+        } catch (lan::errors::pull_error &) {}
+    } check(database.allocator_stats().bits == 2);
+    database.assign<int>("Z", 4);
+    {
+        lan::db_sink sink(output);
+        database.push(sink);
+    } check(output.find("(Q x=i:2 )") != std::string::npos);
+    check(output.find("x=i:1") != std::string::npos);
+    check(output.find("Z=i:4") != std::string::npos);
+}
+
+/* The journal is only created by a push, and replays sets and erases over the file. */
+void test_journal(){
+    std::remove("landb_tests.ldb.journal");
+    make_file("landb_tests.ldb", test_content);
+    {
+        lan::db database;
+        database.set_journal(true);
+        database.connect("landb_tests.ldb");
+        database.pull();
+        check(std::fopen("landb_tests.ldb.journal", "r") == nullptr);
+        database.assign<int>("Count", 7);
+        check(database.push());
+    } {
+        lan::db database;
+        database.set_journal(true);
+        database.connect("landb_tests.ldb");
+        database.pull();
+        check(database.get<int>("Count") == 7);
+        database.erase();
+        database.assign<int>("Count", 8);
+        check(database.push());
+    } {
+        lan::db database;
+        database.set_lazy(true);
+        database.set_journal(true);
+        database.connect("landb_tests.ldb");
+        database.pull();
+        check(database.get<int>("Count") == 8);
+        check(database.size("") == 1);
+        check(database.memory_usage().overall.pending == 0);
+    } std::remove("landb_tests.ldb");
+    std::remove("landb_tests.ldb.journal");
+}
+
+/* Records through a shadowed container or an array element replay over the same bits. */
+void test_journal_shadowed(){
+    std::remove("landb_tests.ldb.journal");
+    make_file("landb_tests.ldb", "(P: x=i:1 ) (P: x=i:2 ) List=a:[ (: y=i:1 ) (: y=i:2 ) ]");
+    {
+        lan::db database;
+        database.set_journal(true);
+        database.connect("landb_tests.ldb");
+        database.pull();
+        database.set_anchor(std::next(database.items("", lan::Container).begin()).get());
+        database.set<int>("@", "x", 5, lan::Int, true);
+        database.set_anchor("List", 1);
+        database.set<int>("@", "y", 7, lan::Int, true);
+        check(database.push());
+    } {
+        lan::db database;
+        database.set_journal(true);
+        database.connect("landb_tests.ldb");
+        database.pull();
+        check(database.get<int>("P", "x") == 1);
+        database.set_anchor(std::next(database.items("", lan::Container).begin()).get());
+        check(database.get<int>("@", "x") == 5);
+        database.set_anchor("List", 0);
+        check(database.get<int>("@", "y") == 1);
+        database.set_anchor("List", 1);
+        check(database.get<int>("@", "y") == 7);
+    } std::remove("landb_tests.ldb");
+    std::remove("landb_tests.ldb.journal");
+}
+
+/* Content split in top-level bits and big arrays and containers, with blanks around <=> and <:>. */
+std::string parallel_content(std::string const & broken){
+    std::string content = "(Group: List=a:[";
+    for(int j = 0 ; j < 20000 ; j++)
+        content += " s:\"item " + std::to_string(j) + "\" (: x=i:" + std::to_string(j) + " )" + ((j == 15000) ? broken : "");
+    content += " ] Tail=i:1 )\nBig=a:[";
+    for(int j = 0 ; j < 40000 ; j++)
+        content += " i:" + std::to_string(j);
+    content += " ]\n";
+    for(int j = 0 ; j < 6000 ; j++)
+        content += "Value" + std::to_string(j) + " = i : " + std::to_string(j) + "\n";
+    return content;
+}
+
+/* A pull on several threads splits big arrays and containers and gives the same bits as one thread. */
+void test_pull_threads(){
+    std::string single, threaded;
+    make_file("landb_tests.ldb", parallel_content(""));
+    for(size_t threads : {1, 4}){
+        lan::db database;
+        database.set_threads(threads);
+        database.connect("landb_tests.ldb");
+        check(database.pull());
+        check(database.size("Group.List") == 40000);
+        check(database.size("Group") == 2);
+        check(database.size("Big") == 40000);
+        check(database.size("") == 6002);
+        check(database.get<int>("Big", 39999) == 39999);
+        check(database.get<int>("Group", "Tail") == 1);
+        check(database.get<int>("Value5999") == 5999);
+        database.set_threads(1);
+        lan::db_sink sink((threads == 1) ? single : threaded);
+        database.push(sink);
+    } std::remove("landb_tests.ldb");
+    check(single == threaded);
+}
+
+/* A bit that fails to parse in a block fails the whole threaded pull, as it does on one thread. */
+void test_pull_threads_error(){
+    std::string messages [2];
+    make_file("landb_tests.ldb", parallel_content(" (Broken x=i:1 )"));
+    for(size_t threads : {1, 4}){
+        lan::db database;
+        database.set_threads(threads);
+        database.connect("landb_tests.ldb");
+        try {
+            database.pull();
+            check(false);
+        } catch (lan::errors::pull_error & error) {
+            messages[threads > 1] = error.what();
+        } check(database.allocator_stats().bits == 0);
+        check(database.empty());
+    } std::remove("landb_tests.ldb");
+    check(messages[0] == messages[1]);
+}
+
+/* A push on several threads splits nested arrays and containers and gives the same output as one thread. */
+void test_push_threads(){
+    std::string content, single, threaded;
+    lan::db database;
+    for(int i = 0 ; i < 3 ; i++){
+        content += "(Group" + std::to_string(i) + ": List=a:[";
+        for(int j = 0 ; j < 6000 ; j++)
+            content += " s:\"item " + std::to_string(j) + "\" (: x=i:" + std::to_string(j) + " )";
+        content += " ] )\n";
+        for(int j = 0 ; j < 6000 ; j++)
+            content += "Value" + std::to_string(j) + "=i:" + std::to_string(j) + "\n";
+    } make_file("landb_tests.ldb", content);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    std::remove("landb_tests.ldb");
+    check(database.size("Group0.List") == 12000);
+    {
+        lan::db_sink sink(single);
+        database.set_threads(1);
+        database.push(sink);
+    } {
+        lan::db_sink sink(threaded);
+        database.set_threads(4);
+        database.push(sink);
+    } check(single == threaded);
+}
+
+/* A push keeps the permissions of the file it replaces. */
+void test_push_mode(){
+    struct stat status;
+    make_file("landb_tests.ldb", test_content);
+    chmod("landb_tests.ldb", 0600);
+    {
+        lan::db database;
+        database.connect("landb_tests.ldb");
+        database.pull();
+        check(database.push());
+    } check(stat("landb_tests.ldb", &status) == 0);
+    check((status.st_mode & 07777) == 0600);
+    std::remove("landb_tests.ldb");
+}
+
+/* Every instruction set finds the same chars as the scalar scan, at every offset and at the end of the buffer. */
+void test_scan_levels(){
+    std::string content, pulled [3];
+    const std::string chars = " \n\t\r=:;()[]\"\\ab0";
+    for(size_t j = 0 ; j < 600 ; j++)
+        content += chars[(j * 7 + j / 13) % chars.length()];
+    content += std::string(70, 'x') + std::string(70, ' ');
+    typedef size_t (* scan)(std::string_view, size_t);
+    std::vector<size_t> expected [4];
+    lan::db_scanner::set_level(lan::scan_scalar);
+    std::vector<scan> scans = {lan::db_scanner::structural, lan::db_scanner::non_blank, lan::db_scanner::quote, lan::db_scanner::bracket};
+    for(size_t kind = 0 ; kind < scans.size() ; kind++)
+        for(size_t offset = 0 ; offset <= content.length() ; offset++)
+            expected[kind].push_back(scans[kind](content, offset));
+    make_file("landb_tests.ldb", test_content);
+    for(lan::db_scan_level level : {lan::scan_scalar, lan::scan_sse2, lan::scan_avx2}){
+        lan::db_scanner::set_level(level);
+        for(size_t kind = 0 ; kind < scans.size() ; kind++)
+            for(size_t offset = 0 ; offset <= content.length() ; offset++)
+                check(scans[kind](content, offset) == expected[kind][offset]);
+        pulled[level] = text_of("landb_tests.ldb");
+        check(pulled[level] == pulled[lan::scan_scalar]);
+    } lan::db_scanner::set_level(lan::scan_avx2);
+    std::remove("landb_tests.ldb");
+}
+
+/* Stats count pulls, pushes, lookups and errors with LANDB_STATS, and stay at zero without it. */
+void test_stats(){
+    lan::db database;
+    lan::db_stats stats;
+    make_file("landb_tests.ldb", test_content);
+    database.connect("landb_tests.ldb");
+    database.reset_stats();
+    database.pull();
+    check(database.get<int>("Count") == -42);
+    check(database.get<std::string>("Person", "Name") == "Ty");
+    try {
+        database.get<int>("Missing");
+        check(false);
+    } catch (lan::errors::bit_name_error &) {}
+    check(database.push());
+    std::remove("landb_tests.ldb");
+    stats = database.stats();
+#ifdef LANDB_STATS
+    check(stats.pulls == 1 and stats.pushes == 1);
+    check(stats.write_ns >= stats.serialize_ns and stats.write_ns > 0);
+    check(stats.lookups >= 3 and stats.visited >= 3);
+    check(stats.allocations >= 24);
+    check(stats.exceptions == 1);
+    database.reset_stats();
+    stats = database.stats();
+#endif
+    check(stats.pulls == 0 and stats.read_ns == 0 and stats.parse_ns == 0 and stats.pushes == 0 and stats.serialize_ns == 0);
+    check(stats.write_ns == 0 and stats.lookups == 0 and stats.visited == 0 and stats.allocations == 0 and stats.exceptions == 0);
+}
+
+/* Memory usage adds up by type of bit, and print shows the same bytes next to every context. */
+void test_memory_usage(){
+    lan::db database;
+    std::string printed;
+    make_file("landb_tests.ldb", test_content);
+    database.connect("landb_tests.ldb");
+    database.pull();
+    database.set<std::string>("Person", "Bio", std::string(200, 'b'));
+    lan::db_memory_usage usage = database.memory_usage(""), person = database.memory_usage("Person");
+    size_t bits = 0, total = 0;
+    for(lan::db_memory const & memory : usage.types){
+        bits += memory.bits;
+        total += memory.total();
+    } check(bits == usage.overall.bits and bits == 25);
+    check(total == usage.overall.total());
+    check(person.overall.bits == 8);
+    check(person.types[lan::String].strings > 200);
+    fflush(stdout);
+    int out = dup(fileno(stdout));
+    check(freopen("landb_tests.ldb", "w", stdout));
+    database.print(0, nullptr, true);
+    fflush(stdout);
+    dup2(out, fileno(stdout));
+    close(out);
+    lan::safe_file file;
+    file.open("landb_tests.ldb");
+    printed = file.pull();
+    std::remove("landb_tests.ldb");
+    check(printed.find("( Person ): " + std::to_string(person.overall.total()) + " bytes (8 bits)\n") != std::string::npos);
+}
+
+int main (int argc, const char * argv []) {
+
+    std::map<std::string, std::function<void()>> tests = {
+        {"roundtrip", test_roundtrip},
+        {"convert", test_convert},
+        {"snapshot", test_snapshot},
+        {"snapshot_shared", test_snapshot_shared},
+        {"snapshot_lazy", test_snapshot_lazy},
+        {"set_typed", test_set_typed},
+        {"items", test_items},
+        {"handle", test_handle},
+        {"handle_set", test_handle_set},
+        {"batch_read", test_batch_read},
+        {"set_index", test_set_index},
+        {"index_shadowed", test_index_shadowed},
+        {"pull_error", test_pull_error},
+        {"arena_release", test_arena_release},
+        {"lazy_error", test_lazy_error},
+        {"journal", test_journal},
+        {"journal_shadowed", test_journal_shadowed},
+        {"pull_threads", test_pull_threads},
+        {"pull_threads_error", test_pull_threads_error},
+        {"push_threads", test_push_threads},
+        {"push_mode", test_push_mode},
+        {"scan_levels", test_scan_levels},
+        {"stats", test_stats},
+        {"memory_usage", test_memory_usage},
+    };
+    std::map<std::string, std::function<void()>> selected;
+    int failures = 0;
+
+    for(int i = 1 ; i < argc ; i++){
+        if(not tests.count(argv[i])) {std::cerr << "unknown test: " << argv[i] << std::endl; return 1;}
+        selected[argv[i]] = tests[argv[i]];
+    } if(selected.empty()) selected = tests;
+
+    for(auto & test : selected){
+        try {
+            test.second();
+            std::cout << test.first << ": ok" << std::endl;
+        } catch (std::exception & error) {
+            std::cout << test.first << ": failed, " << error.what() << std::endl;
+            failures++;
+        }
+    } return (failures) ? 1 : 0;
+
+}